@@ -89,6 +89,11 @@
 #define LASER_FIRE_SPINDLE 11 // fire the laser on M3, extinguish on M5
 #define LASER_FIRE_E 12 // fire the laser when the E axis moves
 
+// Continuous firing (LASER_CONTROL 1) keeps the same duty cycle while the move speeds up and slows down, so the
+// slow ends of each move get more energy per mm. This scales the duty cycle with the step rate during the ramps.
+// Pulsed firing (LASER_CONTROL 3) already fires per distance and does not need it.
+//#define LASER_CONSTANT_ENERGY
+
 // Uncomment these options for the mUVe 1 3D printer
  #define CUSTOM_MENDEL_NAME "mUVe1 Printer"
  #define LASER_WATTS 0.15
@@ -103,6 +108,88 @@
 //#define LASER_PWM 25000 // hertz
 #define LASER_FOCAL_HEIGHT 91.67 // z axis position at which the laser is focused
 
+// Laser/SLA machine without hotend or heated bed. Compiles out the heater control, PID autotune, the heater
+// M-codes (M104, M109, M140, M190, M301, M303, M304), the preheat menus and their EEPROM fields.
+// The temperature ISR is replaced by a monitor for the laser diode and the resin vat, which also keeps polling
+// the LCD buttons. M105 reports the laser diode as T and the vat as B, so hosts can graph them.
+#define LASER_ONLY
+#ifdef LASER_ONLY
+  // Sensor types use the TEMP_SENSOR_x numbering below (thermistors only), 0 = not fitted. Pins are in pins.h.
+  #define LASER_TEMP_SENSOR 1
+  #define VAT_TEMP_SENSOR 1
+  #define LASER_MAXTEMP 60 // (degC) the laser is shut down and the print stopped above this
+  #define VAT_MAXTEMP 50
+  // An open or missing thermistor reads as very cold, below these the laser is shut down and the print stopped
+  #define LASER_MINTEMP 5
+  #define VAT_MINTEMP 5 // the vat heater also stays off below this
+
+  // Optional vat heater on VAT_HEATER_PIN (pins.h), driven like a heated bed: M140/M190 set and wait for the
+  // vat temperature. Uncomment PIDTEMPVAT for PID control (M304 sets the values), else bang-bang is used.
+  #define MAX_VAT_POWER 255 // limits duty cycle to the vat heater; 255=full current
+  //#define PIDTEMPVAT
+  #ifdef PIDTEMPVAT
+    #define  DEFAULT_vatKp 10.00
+    #define  DEFAULT_vatKi .023
+    #define  DEFAULT_vatKd 305.4
+  #endif
+
+  // Exposure compensation. Warm resin cures faster, so the exposure of each layer is scaled by the curve
+  // below at the vat temperature, either through the laser intensity or by speeding up the lasing moves.
+  // The factor is taken on Z moves, so it stays the same for a whole layer. M652 selects the mode.
+  #define VAT_EXPOSURE_COMPENSATION
+  #ifdef VAT_EXPOSURE_COMPENSATION
+    #define VAT_EXPOSURE_MODE 0 // 0 = off, 1 = scale laser intensity, 2 = scale feedrate
+    #define VAT_EXPOSURE_TEMPS { 20, 25, 30, 35, 40 }     // (degC) ascending
+    #define VAT_EXPOSURE_PERCENT { 100, 88, 78, 70, 64 } // exposure needed at each temperature, in % of the nominal one
+  #endif
+#endif
+
+// Laser power calibration. The optical output of the diode is not linear in the PWM duty cycle, it has a threshold
+// and flattens out near full power. M653 fires the laser at LASER_CALIBRATION_POINTS evenly spaced intensities
+// while a photodiode on LASER_PHOTODIODE_PIN (pins.h) looks at the beam, and keeps the measured curve. Intensities
+// are then a share of the measured full output instead of the duty cycle. Store the curve with M500.
+#define LASER_CALIBRATION
+#ifdef LASER_CALIBRATION
+  #define LASER_CALIBRATION_POINTS 11 // 0%, 10%, ... 100%
+  #define LASER_CALIBRATION_SETTLE 100 // (ms) default time the diode gets at each step before it is measured
+#endif
+
+// Laser lifetime accounting, to plan the replacement of the diode. The on time is added up between the laser_fire()
+// and laser_extinguish() edges in Timer0 overflows, and saved to a ring of LASER_LIFETIME_SLOTS EEPROM slots
+// at the top of the EEPROM, each save going to the next slot. The settings grow from the bottom, so a new
+// settings layout never moves the ring and loses the count. M654 reports it, M654 R resets it for a new diode.
+#define LASER_LIFETIME
+#ifdef LASER_LIFETIME
+  #define LASER_LIFETIME_SAVE_INTERVAL 600 // (s) of on time between saves, up to this much is lost on a power cut
+  #define LASER_LIFETIME_SLOTS 16 // 8 bytes each
+  #define LASER_LIFETIME_EEPROM_OFFSET (E2END + 1 - LASER_LIFETIME_SLOTS * 8)
+#endif
+
+// XY correction map, for the image distortion of a racked gantry or stretched belts. The map holds the position
+// error measured at a grid of points, e.g. on a printed calibration grid, and the planner takes the error
+// interpolated at each target off it. M655 sets the points, store them with M500. Lines longer than
+// XY_CORRECTION_SEGMENT are cut so they follow the map.
+#define XY_CORRECTION
+#ifdef XY_CORRECTION
+  #define XY_CORRECTION_POINTS_X 5
+  #define XY_CORRECTION_POINTS_Y 5
+  #define XY_CORRECTION_MIN_X X_MIN_POS // (mm) the corner points of the grid
+  #define XY_CORRECTION_MAX_X X_MAX_POS
+  #define XY_CORRECTION_MIN_Y Y_MIN_POS
+  #define XY_CORRECTION_MAX_Y Y_MAX_POS
+  #define XY_CORRECTION_SEGMENT 5.0 // (mm)
+#endif
+
+// Build plate tilt compensation. M656 takes the height error of the plate measured at three points. The plane
+// through them goes through the bed leveling rotation matrix of vector_3.cpp once, and its height where each
+// Z motor holds the plate (the second one is E with MUVE_Z_PEEL) becomes a fixed offset of that motor. The
+// offsets are only applied by moves in Z, layer changes and peels; XY moves never step the Z motors.
+#define PLATE_TILT_COMPENSATION
+#ifdef PLATE_TILT_COMPENSATION
+  #define PLATE_TILT_POINTS { { X_MIN_POS, Y_MIN_POS }, { X_MAX_POS, Y_MIN_POS }, { X_MIN_POS, Y_MAX_POS } } // (mm)
+  #define PLATE_TILT_MOTOR_POS { { X_MIN_POS, (Y_MIN_POS+Y_MAX_POS)/2 }, { X_MAX_POS, (Y_MIN_POS+Y_MAX_POS)/2 } } // (mm) Z, second Z
+#endif
+
 //===========================================================================
 //=============================Thermal Settings  ============================
 //===========================================================================
@@ -366,6 +453,14 @@ const bool Z_MAX_ENDSTOP_INVERTING = false; // set to true to invert the logic o
 #define DEFAULT_ZJERK                 0.0     // (mm/sec)
 #define DEFAULT_EJERK                 0.0    // (mm/sec)
 
+// Junction deviation cornering replaces the jerk limits above. The corner speed is the one at which the block
+// acceleration takes the move around an arc that stays DEFAULT_JUNCTION_DEVIATION away from the corner, so shallow
+// angles are taken at nearly full speed and sharp ones slow down. M205 J sets it, J0 goes back to the jerk limits.
+#define JUNCTION_DEVIATION
+#ifdef JUNCTION_DEVIATION
+  #define DEFAULT_JUNCTION_DEVIATION 0.02 // (mm)
+#endif
+
 //===========================================================================
 //=============================Additional Features===========================
 //===========================================================================
@@ -380,6 +475,13 @@ const bool Z_MAX_ENDSTOP_INVERTING = false; // set to true to invert the logic o
 //to disable EEPROM Serial responses and decrease program space by ~1700 byte: comment this out:
 // please keep turned on if you can.
 #define EEPROM_CHITCHAT
+// Write the EEPROM in the background from the EE_READY interrupt, instead of holding the main loop for 3.3ms per
+// changed byte. The bytes wait in a RAM buffer of EEPROM_WRITE_BUFFER_SIZE bytes that holds a whole settings
+// record, so M500 only waits while the record of an earlier M500 is still going in. The host gets
+// "Settings written to EEPROM" once they are all in. Costs about 420 bytes of RAM, check the free RAM of your
+// build before turning it on.
+//#define EEPROM_BACKGROUND_WRITES
+#define EEPROM_WRITE_BUFFER_SIZE 384 // at least the settings slot size
 
 // Preheat Constants
 #define PLA_PREHEAT_HOTEND_TEMP 180
@@ -417,6 +519,11 @@ const bool Z_MAX_ENDSTOP_INVERTING = false; // set to true to invert the logic o
 // ==> REMEMBER TO INSTALL U8glib to your ARDUINO library folder: http://code.google.com/p/u8glib/wiki/u8glib
 #define REPRAP_DISCOUNT_FULL_GRAPHIC_SMART_CONTROLLER
 
+// Drive its ST7920 from the hardware SPI, shared with the SD card, instead of bit-banging it, and send only the
+// 16 pixel words that changed since the last frame (1 KB of RAM for the copy). Needs the E (clock) and R/W (data)
+// lines of the display moved to SCK (D52) and MOSI (D51) of the SD card header.
+//#define ST7920_HARDWARE_SPI
+
 // The RepRapWorld REPRAPWORLD_KEYPAD v1.1
 // http://reprapworld.com/?products_details&products_id=202&cPath=1591_1626
 //#define REPRAPWORLD_KEYPAD
@@ -527,6 +634,9 @@ const bool Z_MAX_ENDSTOP_INVERTING = false; // set to true to invert the logic o
 # ifndef DEFAULT_LCD_CONTRAST
 #  define DEFAULT_LCD_CONTRAST 32
 # endif
+// Draw one page of the picture loop per lcd_update() call, so commands and the planner are served between the
+// pages, and send only the ST7920 rows that changed since the frame before. M658 reports the longest lcd_update().
+# define LCD_INCREMENTAL_UPDATE
 #endif
 
 // Increase the FAN pwm frequency. Removes the PWM noise but increases heating in the FET/Arduino
@@ -1,23 +1,124 @@
 #include "Marlin.h"
 #include "planner.h"
-#ifndef LASER
+#if !defined(LASER) || defined(LASER_ONLY)
 #include "temperature.h"
 #endif
 #include "ultralcd.h"
 #include "ConfigurationStore.h"
+#include <util/crc16.h>
 
+#ifdef EEPROM_BACKGROUND_WRITES
+// Runs of consecutive addresses, their bytes are copied in order to eeprom_data
+#define EEPROM_WRITE_RUNS 8 // power of 2
+typedef struct {
+    uint16_t address; // of the next byte to write
+    uint16_t length;  // bytes left in the run
+} eeprom_run_t;
+
+static uint8_t eeprom_data[EEPROM_WRITE_BUFFER_SIZE];
+static uint16_t eeprom_data_head, eeprom_data_tail;
+static volatile uint16_t eeprom_data_count;
+static eeprom_run_t eeprom_runs[EEPROM_WRITE_RUNS];
+static uint8_t eeprom_run_head, eeprom_run_tail;
+static volatile uint8_t eeprom_run_count;
+
+// Fires while EERIE is set and the EEPROM is not busy. Starts the write of the next queued byte that differs from
+// the EEPROM, and turns itself off once the queue is empty. Skips at most 8 unchanged bytes per call, to keep
+// the stepper interrupt waiting no longer than a few microseconds.
+ISR(EE_READY_vect)
+{
+    for (uint8_t n = 0; n < 8; n++)
+    {
+        if (eeprom_run_count == 0)
+        {
+            EECR &= ~_BV(EERIE);
+            return;
+        }
+        eeprom_run_t *run = &eeprom_runs[eeprom_run_tail];
+        uint8_t value = eeprom_data[eeprom_data_tail];
+        if (++eeprom_data_tail == EEPROM_WRITE_BUFFER_SIZE)
+            eeprom_data_tail = 0;
+        eeprom_data_count--;
+        EEAR = run->address++;
+        if (--run->length == 0)
+        {
+            eeprom_run_tail = (eeprom_run_tail + 1) & (EEPROM_WRITE_RUNS - 1);
+            eeprom_run_count--;
+        }
+        EECR |= _BV(EERE);
+        if (EEDR != value)
+        {
+            EEDR = value;
+            EECR |= _BV(EEMPE);
+            EECR |= _BV(EEPE);
+            return;
+        }
+    }
+}
+
+// Copies the bytes to the queue and returns, only waiting while an earlier save still fills it. The interrupt is
+// off while the queue is changed, a write it already started carries on.
+void _EEPROM_writeData(int &pos, uint8_t* value, uint8_t size)
+{
+    eeprom_run_t *last;
+    bool extend;
+    for (;;)
+    {
+        EECR &= ~_BV(EERIE);
+        last = &eeprom_runs[(eeprom_run_head - 1) & (EEPROM_WRITE_RUNS - 1)];
+        extend = eeprom_run_count && last->address + last->length == pos;
+        if (eeprom_data_count + size <= EEPROM_WRITE_BUFFER_SIZE && (extend || eeprom_run_count < EEPROM_WRITE_RUNS))
+            break;
+        EECR |= _BV(EERIE);
+    }
+    for (uint8_t n = 0; n < size; n++)
+    {
+        eeprom_data[eeprom_data_head] = value[n];
+        if (++eeprom_data_head == EEPROM_WRITE_BUFFER_SIZE)
+            eeprom_data_head = 0;
+    }
+    eeprom_data_count += size;
+    if (extend)
+        last->length += size;
+    else
+    {
+        eeprom_runs[eeprom_run_head].address = pos;
+        eeprom_runs[eeprom_run_head].length = size;
+        eeprom_run_head = (eeprom_run_head + 1) & (EEPROM_WRITE_RUNS - 1);
+        eeprom_run_count++;
+    }
+    pos += size;
+    EECR |= _BV(EERIE);
+}
+
+// The interrupt stays enabled until the last write has finished
+bool eeprom_write_pending()
+{
+    return EECR & _BV(EERIE);
+}
+
+// Reads must wait for the queue, the EEPROM would give the old bytes and the interrupt would move EEAR under them
+void eeprom_write_flush()
+{
+    while (eeprom_write_pending()) ;
+}
+#else
+// Only writes the bytes that differ, an unchanged byte costs a read instead of a 3.3ms erase and write cycle
 void _EEPROM_writeData(int &pos, uint8_t* value, uint8_t size)
 {
     do
     {
-        eeprom_write_byte((unsigned char*)pos, *value);
+        if (eeprom_read_byte((unsigned char*)pos) != *value)
+            eeprom_write_byte((unsigned char*)pos, *value);
         pos++;
         value++;
     }while(--size);
 }
+#endif // EEPROM_BACKGROUND_WRITES
 #define EEPROM_WRITE_VAR(pos, value) _EEPROM_writeData(pos, (uint8_t*)&value, sizeof(value))
 void _EEPROM_readData(int &pos, uint8_t* value, uint8_t size)
 {
+    eeprom_write_flush();
     do
     {
         *value = eeprom_read_byte((unsigned char*)pos);
@@ -31,73 +132,260 @@ void _EEPROM_readData(int &pos, uint8_t* value, uint8_t size)
 
 
 
+// The settings are stored as a record of tagged fields, in one of EEPROM_SLOTS slots. Every save that changes
+// something goes to the next slot with the next sequence number, so each slot sees one in EEPROM_SLOTS of the
+// writes. The newest slot whose fields match their CRC is loaded, a save cut short by a reset leaves the one
+// before in use.
 #define EEPROM_OFFSET 100
+#define EEPROM_SLOT_SIZE 384
+#define EEPROM_SLOTS 4
+#define EEPROM_SLOT(slot) (EEPROM_OFFSET + (slot) * EEPROM_SLOT_SIZE)
+
+#if defined(EEPROM_BACKGROUND_WRITES) && EEPROM_WRITE_BUFFER_SIZE < EEPROM_SLOT_SIZE
+  #error "EEPROM_WRITE_BUFFER_SIZE must hold a whole settings slot (EEPROM_SLOT_SIZE)"
+#endif
 
+#if defined(LASER_LIFETIME) && EEPROM_SLOT(EEPROM_SLOTS) > LASER_LIFETIME_EEPROM_OFFSET
+  #error "The settings slots overlap the laser lifetime ring, move LASER_LIFETIME_EEPROM_OFFSET up"
+#endif
+
+typedef struct {
+    uint16_t sequence; // the newest record has the highest one
+    uint16_t length;   // of the fields after the header
+    uint16_t crc;      // CRC-16/CCITT of the fields
+} eeprom_header_t;
+
+// Each field is its tag, its size in bytes and the value. A field missing from the stored record, or stored with
+// another size, keeps its default on load and the rest of the record is still used. So a new setting only needs
+// a new tag, never reuse or renumber a tag. A setting that changes type gets a new tag as well.
+enum {
+    EEPROM_STEPS_PER_UNIT = 1,
+    EEPROM_MAX_FEEDRATE = 2,
+    EEPROM_MAX_ACCELERATION = 3,
+    EEPROM_ACCELERATION = 4,
+    EEPROM_RETRACT_ACCELERATION = 5,
+    EEPROM_MINIMUMFEEDRATE = 6,
+    EEPROM_MINTRAVELFEEDRATE = 7,
+    EEPROM_MINSEGMENTTIME = 8,
+    EEPROM_MAX_XY_JERK = 9,
+    EEPROM_MAX_Z_JERK = 10,
+    EEPROM_MAX_E_JERK = 11,
+    EEPROM_JUNCTION_DEVIATION = 12,
+    EEPROM_ADD_HOMEING = 13,
+    EEPROM_ENDSTOP_ADJ = 14,
+    EEPROM_PLA_PREHEAT_HOTEND_TEMP = 15,
+    EEPROM_PLA_PREHEAT_HPB_TEMP = 16,
+    EEPROM_PLA_PREHEAT_FAN_SPEED = 17,
+    EEPROM_ABS_PREHEAT_HOTEND_TEMP = 18,
+    EEPROM_ABS_PREHEAT_HPB_TEMP = 19,
+    EEPROM_ABS_PREHEAT_FAN_SPEED = 20,
+    EEPROM_KP = 21,
+    EEPROM_KI = 22,
+    EEPROM_KD = 23,
+    EEPROM_VAT_KP = 24,
+    EEPROM_VAT_KI = 25,
+    EEPROM_VAT_KD = 26,
+    EEPROM_VAT_EXPOSURE_MODE = 27,
+    EEPROM_LASER_CALIBRATION = 28,
+    EEPROM_LCD_CONTRAST = 29,
+    EEPROM_XY_CORRECTION = 30,
+    EEPROM_PLATE_TILT = 31
+};
 
-// IMPORTANT:  Whenever there are changes made to the variables stored in EEPROM
-// in the functions below, also increment the version number. This makes sure that
-// the default values are used whenever there is a change to the data, to prevent
-// wrong data being written to the variables.
-// ALSO:  always make sure the variables in the Store and retrieve sections are in the same order.
-#define EEPROM_VERSION "V10"
+static void Config_Defaults();
 
 #ifdef EEPROM_SETTINGS
-void Config_StoreSettings()
+static eeprom_header_t eeprom_record; // header of the newest record
+static uint8_t eeprom_record_slot;
+static uint16_t eeprom_crc;
+static bool eeprom_dry_run; // only work out the length and CRC of the fields
+static uint8_t eeprom_missing_fields;
+#ifdef EEPROM_BACKGROUND_WRITES
+static bool eeprom_store_queued; // an M500 record is still being written
+#endif
+
+static void _EEPROM_writeField(int &pos, uint8_t tag, uint8_t* value, uint8_t size)
 {
-  char ver[4]= "000";
-  int i=EEPROM_OFFSET;
-  EEPROM_WRITE_VAR(i,ver); // invalidate data first
-  EEPROM_WRITE_VAR(i,axis_steps_per_unit);
-  EEPROM_WRITE_VAR(i,max_feedrate);
-  EEPROM_WRITE_VAR(i,max_acceleration_units_per_sq_second);
-  EEPROM_WRITE_VAR(i,acceleration);
-  EEPROM_WRITE_VAR(i,retract_acceleration);
-  EEPROM_WRITE_VAR(i,minimumfeedrate);
-  EEPROM_WRITE_VAR(i,mintravelfeedrate);
-  EEPROM_WRITE_VAR(i,minsegmenttime);
-  EEPROM_WRITE_VAR(i,max_xy_jerk);
-  EEPROM_WRITE_VAR(i,max_z_jerk);
-  EEPROM_WRITE_VAR(i,max_e_jerk);
-  EEPROM_WRITE_VAR(i,add_homeing);
-  #ifdef DELTA
-  EEPROM_WRITE_VAR(i,endstop_adj);
+    uint8_t field[2] = { tag, size };
+    for(uint8_t n=0; n < 2; n++)
+        eeprom_crc = _crc_ccitt_update(eeprom_crc, field[n]);
+    for(uint8_t n=0; n < size; n++)
+        eeprom_crc = _crc_ccitt_update(eeprom_crc, value[n]);
+    if(eeprom_dry_run)
+    {
+        pos += 2 + size;
+        return;
+    }
+    _EEPROM_writeData(pos, field, 2);
+    _EEPROM_writeData(pos, value, size);
+}
+#define EEPROM_WRITE_FIELD(pos, tag, value) _EEPROM_writeField(pos, tag, (uint8_t*)&value, sizeof(value))
+
+static bool _EEPROM_readField(uint8_t tag, uint8_t* value, uint8_t size)
+{
+    int pos = EEPROM_SLOT(eeprom_record_slot) + sizeof(eeprom_header_t);
+    int end = pos + eeprom_record.length;
+    while(pos + 2 <= end)
+    {
+        uint8_t field_tag = eeprom_read_byte((unsigned char*)pos);
+        uint8_t field_size = eeprom_read_byte((unsigned char*)pos + 1);
+        pos += 2;
+        if(field_tag == tag)
+        {
+            if(field_size != size || pos + size > end)
+                break;
+            _EEPROM_readData(pos, value, size);
+            return true;
+        }
+        pos += field_size;
+    }
+    eeprom_missing_fields++;
+    return false;
+}
+#define EEPROM_READ_FIELD(tag, value) _EEPROM_readField(tag, (uint8_t*)&value, sizeof(value))
+
+// Finds the newest valid record. Without one the next save goes to slot 1, so a flat record imported by
+// Config_ImportFlatRecord() stays readable until the tagged one is complete.
+static bool Config_FindRecord()
+{
+    eeprom_write_flush();
+    bool found = false;
+    eeprom_record.sequence = 0;
+    eeprom_record_slot = 0;
+    for(uint8_t slot=0; slot < EEPROM_SLOTS; slot++)
+    {
+        eeprom_header_t header;
+        int i = EEPROM_SLOT(slot);
+        EEPROM_READ_VAR(i,header);
+        if(header.length > EEPROM_SLOT_SIZE - sizeof(eeprom_header_t))
+            continue;
+        uint16_t crc = 0xFFFF;
+        for(uint16_t n=0; n < header.length; n++)
+            crc = _crc_ccitt_update(crc, eeprom_read_byte((unsigned char*)i++));
+        if(crc != header.crc || (found && (int16_t)(header.sequence - eeprom_record.sequence) <= 0))
+            continue;
+        found = true;
+        eeprom_record = header;
+        eeprom_record_slot = slot;
+    }
+    return found;
+}
+
+static void Config_WriteFields(int &i)
+{
+  EEPROM_WRITE_FIELD(i,EEPROM_STEPS_PER_UNIT,axis_steps_per_unit);
+  EEPROM_WRITE_FIELD(i,EEPROM_MAX_FEEDRATE,max_feedrate);
+  EEPROM_WRITE_FIELD(i,EEPROM_MAX_ACCELERATION,max_acceleration_units_per_sq_second);
+  EEPROM_WRITE_FIELD(i,EEPROM_ACCELERATION,acceleration);
+  EEPROM_WRITE_FIELD(i,EEPROM_RETRACT_ACCELERATION,retract_acceleration);
+  EEPROM_WRITE_FIELD(i,EEPROM_MINIMUMFEEDRATE,minimumfeedrate);
+  EEPROM_WRITE_FIELD(i,EEPROM_MINTRAVELFEEDRATE,mintravelfeedrate);
+  EEPROM_WRITE_FIELD(i,EEPROM_MINSEGMENTTIME,minsegmenttime);
+  EEPROM_WRITE_FIELD(i,EEPROM_MAX_XY_JERK,max_xy_jerk);
+  EEPROM_WRITE_FIELD(i,EEPROM_MAX_Z_JERK,max_z_jerk);
+  EEPROM_WRITE_FIELD(i,EEPROM_MAX_E_JERK,max_e_jerk);
+  #ifdef JUNCTION_DEVIATION
+  EEPROM_WRITE_FIELD(i,EEPROM_JUNCTION_DEVIATION,junction_deviation);
   #endif
-  /*
-  #ifdef LASER
-  EEPROM_WRITE_VAR(i,laser.lifetime);
+  EEPROM_WRITE_FIELD(i,EEPROM_ADD_HOMEING,add_homeing);
+  #ifdef DELTA
+  EEPROM_WRITE_FIELD(i,EEPROM_ENDSTOP_ADJ,endstop_adj);
   #endif
-  */
-  #ifndef ULTIPANEL
-  int plaPreheatHotendTemp = PLA_PREHEAT_HOTEND_TEMP, plaPreheatHPBTemp = PLA_PREHEAT_HPB_TEMP, plaPreheatFanSpeed = PLA_PREHEAT_FAN_SPEED;
-  int absPreheatHotendTemp = ABS_PREHEAT_HOTEND_TEMP, absPreheatHPBTemp = ABS_PREHEAT_HPB_TEMP, absPreheatFanSpeed = ABS_PREHEAT_FAN_SPEED;
+  #if defined(ULTIPANEL) && !defined(LASER_ONLY)
+  EEPROM_WRITE_FIELD(i,EEPROM_PLA_PREHEAT_HOTEND_TEMP,plaPreheatHotendTemp);
+  EEPROM_WRITE_FIELD(i,EEPROM_PLA_PREHEAT_HPB_TEMP,plaPreheatHPBTemp);
+  EEPROM_WRITE_FIELD(i,EEPROM_PLA_PREHEAT_FAN_SPEED,plaPreheatFanSpeed);
+  EEPROM_WRITE_FIELD(i,EEPROM_ABS_PREHEAT_HOTEND_TEMP,absPreheatHotendTemp);
+  EEPROM_WRITE_FIELD(i,EEPROM_ABS_PREHEAT_HPB_TEMP,absPreheatHPBTemp);
+  EEPROM_WRITE_FIELD(i,EEPROM_ABS_PREHEAT_FAN_SPEED,absPreheatFanSpeed);
   #endif
-  EEPROM_WRITE_VAR(i,plaPreheatHotendTemp);
-  EEPROM_WRITE_VAR(i,plaPreheatHPBTemp);
-  EEPROM_WRITE_VAR(i,plaPreheatFanSpeed);
-  EEPROM_WRITE_VAR(i,absPreheatHotendTemp);
-  EEPROM_WRITE_VAR(i,absPreheatHPBTemp);
-  EEPROM_WRITE_VAR(i,absPreheatFanSpeed);
   #ifdef PIDTEMP
-    EEPROM_WRITE_VAR(i,Kp);
-    EEPROM_WRITE_VAR(i,Ki);
-    EEPROM_WRITE_VAR(i,Kd);
-  #else
-		float dummy = 3000.0f;
-    EEPROM_WRITE_VAR(i,dummy);
-		dummy = 0.0f;
-    EEPROM_WRITE_VAR(i,dummy);
-    EEPROM_WRITE_VAR(i,dummy);
+  EEPROM_WRITE_FIELD(i,EEPROM_KP,Kp);
+  EEPROM_WRITE_FIELD(i,EEPROM_KI,Ki);
+  EEPROM_WRITE_FIELD(i,EEPROM_KD,Kd);
+  #endif
+  #ifdef PIDTEMPVAT
+  EEPROM_WRITE_FIELD(i,EEPROM_VAT_KP,vatKp);
+  EEPROM_WRITE_FIELD(i,EEPROM_VAT_KI,vatKi);
+  EEPROM_WRITE_FIELD(i,EEPROM_VAT_KD,vatKd);
+  #endif
+  #ifdef VAT_EXPOSURE_COMPENSATION
+  EEPROM_WRITE_FIELD(i,EEPROM_VAT_EXPOSURE_MODE,vat_exposure_mode);
   #endif
-  #ifndef DOGLCD
-    int lcd_contrast = 32;
+  #ifdef LASER_CALIBRATION
+  EEPROM_WRITE_FIELD(i,EEPROM_LASER_CALIBRATION,laser_calibration);
   #endif
-  EEPROM_WRITE_VAR(i,lcd_contrast);
-  char ver2[4]=EEPROM_VERSION;
-  i=EEPROM_OFFSET;
-  EEPROM_WRITE_VAR(i,ver2); // validate data
-  SERIAL_ECHO_START;
-  SERIAL_ECHOLNPGM("Settings Stored");
+  #ifdef DOGLCD
+  EEPROM_WRITE_FIELD(i,EEPROM_LCD_CONTRAST,lcd_contrast);
+  #endif
+  #ifdef XY_CORRECTION
+  EEPROM_WRITE_FIELD(i,EEPROM_XY_CORRECTION,xy_correction);
+  #endif
+  #ifdef PLATE_TILT_COMPENSATION
+  EEPROM_WRITE_FIELD(i,EEPROM_PLATE_TILT,plate_tilt);
+  #endif
+}
+
+static void Config_StoreRecord()
+{
+  bool found = Config_FindRecord();
+  // Work out the new record first, it is not written again when nothing changed
+  int i = 0;
+  eeprom_crc = 0xFFFF;
+  eeprom_dry_run = true;
+  Config_WriteFields(i);
+  eeprom_header_t header = { eeprom_record.sequence + 1, (uint16_t)i, eeprom_crc };
+  if(found && header.length == eeprom_record.length && header.crc == eeprom_record.crc)
+  {
+    SERIAL_ECHO_START;
+    SERIAL_ECHOLNPGM("Settings unchanged");
+  }
+  else if(header.length > EEPROM_SLOT_SIZE - sizeof(eeprom_header_t))
+  {
+    SERIAL_ERROR_START;
+    SERIAL_ERRORLNPGM("Settings do not fit in EEPROM_SLOT_SIZE, not stored");
+  }
+  else
+  {
+    uint8_t slot = (eeprom_record_slot + 1) % EEPROM_SLOTS;
+    i = EEPROM_SLOT(slot) + sizeof(eeprom_header_t);
+    eeprom_dry_run = false;
+    Config_WriteFields(i);
+    // The header goes last, until then the slot fails its CRC and the previous record stays in use
+    i = EEPROM_SLOT(slot);
+    EEPROM_WRITE_VAR(i,header);
+    eeprom_record = header;
+    eeprom_record_slot = slot;
+    SERIAL_ECHO_START;
+    SERIAL_ECHOLNPGM("Settings Stored");
+    #ifdef EEPROM_BACKGROUND_WRITES
+    eeprom_store_queued = true;
+    #endif
+  }
 }
+
+void Config_StoreSettings()
+{
+  Config_StoreRecord();
+  #ifdef LASER_LIFETIME
+  // Kept in its own ring, so M502 does not lose it
+  laser_lifetime_update();
+  laser_lifetime_save();
+  #endif
+}
+
+#ifdef EEPROM_BACKGROUND_WRITES
+// Called from the main loop, tells the host once the record of the last M500 is all in the EEPROM
+void Config_ReportStored()
+{
+  if(eeprom_store_queued && !eeprom_write_pending())
+  {
+    eeprom_store_queued = false;
+    SERIAL_ECHO_START;
+    SERIAL_ECHOLNPGM("Settings written to EEPROM");
+  }
+}
+#endif
 #endif //EEPROM_SETTINGS
 
 
@@ -138,7 +426,7 @@ void Config_PrintSettings()
     SERIAL_ECHOLN("");
 
     SERIAL_ECHO_START;
-    SERIAL_ECHOLNPGM("Advanced variables: S=Min feedrate (mm/s), T=Min travel feedrate (mm/s), B=minimum segment time (ms), X=maximum XY jerk (mm/s),  Z=maximum Z jerk (mm/s),  E=maximum E jerk (mm/s)");
+    SERIAL_ECHOLNPGM("Advanced variables: S=Min feedrate (mm/s), T=Min travel feedrate (mm/s), B=minimum segment time (ms), X=maximum XY jerk (mm/s),  Z=maximum Z jerk (mm/s),  E=maximum E jerk (mm/s), J=junction deviation (mm)");
     SERIAL_ECHO_START;
     SERIAL_ECHOPAIR("  M205 S",minimumfeedrate );
     SERIAL_ECHOPAIR(" T" ,mintravelfeedrate );
@@ -146,6 +434,9 @@ void Config_PrintSettings()
     SERIAL_ECHOPAIR(" X" ,max_xy_jerk );
     SERIAL_ECHOPAIR(" Z" ,max_z_jerk);
     SERIAL_ECHOPAIR(" E" ,max_e_jerk);
+#ifdef JUNCTION_DEVIATION
+    SERIAL_ECHOPAIR(" J" ,junction_deviation);
+#endif
     SERIAL_ECHOLN("");
 
     SERIAL_ECHO_START;
@@ -164,17 +455,41 @@ void Config_PrintSettings()
     SERIAL_ECHOPAIR(" Z" ,endstop_adj[2] );
     SERIAL_ECHOLN("");
 #endif
-    /*
-#ifdef LASER
-	SERIAL_ECHO_START;
-	SERIAL_ECHOLNPGM("Laser lifetime usage:");
-	SERIAL_ECHO_START;
-    SERIAL_ECHOPAIR(" Hours: ",(unsigned long)labs(laser.lifetime / 60));
-    SERIAL_ECHOLN("");
-    SERIAL_ECHOPAIR(" Minutes: ",(unsigned long)laser.lifetime % 60);
-    SERIAL_ECHOLN("");
+#ifdef XY_CORRECTION
+    SERIAL_ECHO_START;
+    SERIAL_ECHOLNPGM("XY correction map, points with an error (mm):");
+    for (uint8_t j = 0; j < XY_CORRECTION_POINTS_Y; j++)
+      for (uint8_t i = 0; i < XY_CORRECTION_POINTS_X; i++) {
+        if (xy_correction[j][i][X_AXIS] == 0 && xy_correction[j][i][Y_AXIS] == 0) continue;
+        SERIAL_ECHO_START;
+        SERIAL_ECHOPAIR("   M655 I",(unsigned long)i);
+        SERIAL_ECHOPAIR(" J",(unsigned long)j);
+        SERIAL_ECHOPAIR(" X",xy_correction[j][i][X_AXIS] / 1000.0);
+        SERIAL_ECHOPAIR(" Y",xy_correction[j][i][Y_AXIS] / 1000.0);
+        SERIAL_ECHOLN("");
+      }
+#endif
+#ifdef PLATE_TILT_COMPENSATION
+    SERIAL_ECHO_START;
+    SERIAL_ECHOLNPGM("Build plate height error (mm):");
+    for (uint8_t p = 0; p < 3; p++) {
+      SERIAL_ECHO_START;
+      SERIAL_ECHOPAIR("   M656 P",(unsigned long)p);
+      SERIAL_ECHOPAIR(" X",plate_tilt[p][X_AXIS]);
+      SERIAL_ECHOPAIR(" Y",plate_tilt[p][Y_AXIS]);
+      SERIAL_ECHOPAIR(" Z",plate_tilt[p][Z_AXIS]);
+      SERIAL_ECHOLN("");
+    }
+#endif
+#ifdef LASER_LIFETIME
+    laser_lifetime_update();
+    SERIAL_ECHO_START;
+    SERIAL_ECHOLNPGM("Laser on time (s):");
+    SERIAL_ECHO_START;
+    SERIAL_ECHOPAIR("   M654 S",laser.lifetime);
+    SERIAL_ECHOPAIR(" (hours: ",laser.lifetime / 3600);
+    SERIAL_ECHOLN(")");
 #endif
-    */
 #ifdef PIDTEMP
     SERIAL_ECHO_START;
     SERIAL_ECHOLNPGM("PID settings:");
@@ -184,44 +499,97 @@ void Config_PrintSettings()
     SERIAL_ECHOPAIR(" D" ,unscalePID_d(Kd));
     SERIAL_ECHOLN("");
 #endif
+#ifdef PIDTEMPVAT
+    SERIAL_ECHO_START;
+    SERIAL_ECHOLNPGM("Vat PID settings:");
+    SERIAL_ECHO_START;
+    SERIAL_ECHOPAIR("   M304 P",vatKp);
+    SERIAL_ECHOPAIR(" I" ,unscalePID_i(vatKi));
+    SERIAL_ECHOPAIR(" D" ,unscalePID_d(vatKd));
+    SERIAL_ECHOLN("");
+#endif
+#ifdef VAT_EXPOSURE_COMPENSATION
+    SERIAL_ECHO_START;
+    SERIAL_ECHOLNPGM("Vat exposure compensation (0 off, 1 intensity, 2 feedrate):");
+    SERIAL_ECHO_START;
+    SERIAL_ECHOPAIR("   M652 S",(unsigned long)vat_exposure_mode);
+    SERIAL_ECHOLN("");
+#endif
+#ifdef LASER_CALIBRATION
+    SERIAL_ECHO_START;
+    SERIAL_ECHOLNPGM("Laser output curve (M653 measures it):");
+    SERIAL_ECHO_START;
+    for (uint8_t p = 0; p < LASER_CALIBRATION_POINTS; p++) {
+      SERIAL_ECHO(" ");
+      SERIAL_ECHO(laser_calibration[p]);
+    }
+    SERIAL_ECHOLN("");
+#endif
 }
 #endif
 
 
+
 #ifdef EEPROM_SETTINGS
-void Config_RetrieveSettings()
+// The flat record of the firmware before the tagged slots: its version string at EEPROM_OFFSET, then the
+// settings in a fixed order. "V10" is the layout of the released firmware. "V11" added the junction deviation
+// and the laser calibration, "L13" is the LASER_ONLY one with the vat instead of the preheat and hotend PID
+// fields. Older layouts load the defaults as they always did.
+#ifdef LASER_ONLY
+  #define EEPROM_FLAT_VERSION "L13"
+#else
+  #define EEPROM_FLAT_VERSION "V11"
+#endif
+
+static bool Config_ImportFlatRecord()
 {
     int i=EEPROM_OFFSET;
     char stored_ver[4];
-    char ver[4]=EEPROM_VERSION;
-    EEPROM_READ_VAR(i,stored_ver); //read stored version
-    //  SERIAL_ECHOLN("Version: [" << ver << "] Stored version: [" << stored_ver << "]");
-    if (strncmp(ver,stored_ver,3) == 0)
+    char ver[4]=EEPROM_FLAT_VERSION;
+    EEPROM_READ_VAR(i,stored_ver);
+    bool v10 = strncmp("V10",stored_ver,3) == 0;
+    if (!v10 && strncmp(ver,stored_ver,3) != 0)
+        return false;
+    // Settings added since keep their defaults
+    Config_Defaults();
+    EEPROM_READ_VAR(i,axis_steps_per_unit);
+    EEPROM_READ_VAR(i,max_feedrate);
+    EEPROM_READ_VAR(i,max_acceleration_units_per_sq_second);
+    EEPROM_READ_VAR(i,acceleration);
+    EEPROM_READ_VAR(i,retract_acceleration);
+    reset_acceleration_rates();
+    EEPROM_READ_VAR(i,minimumfeedrate);
+    EEPROM_READ_VAR(i,mintravelfeedrate);
+    EEPROM_READ_VAR(i,minsegmenttime);
+    EEPROM_READ_VAR(i,max_xy_jerk);
+    EEPROM_READ_VAR(i,max_z_jerk);
+    EEPROM_READ_VAR(i,max_e_jerk);
+    #ifdef JUNCTION_DEVIATION
+    if (!v10)
+        EEPROM_READ_VAR(i,junction_deviation);
+    #endif
+    EEPROM_READ_VAR(i,add_homeing);
+    #ifdef DELTA
+    EEPROM_READ_VAR(i,endstop_adj);
+    #endif
+    #ifdef LASER_ONLY
+    if (!v10)
     {
-        // version number match
-        EEPROM_READ_VAR(i,axis_steps_per_unit);
-        EEPROM_READ_VAR(i,max_feedrate);
-        EEPROM_READ_VAR(i,max_acceleration_units_per_sq_second);
-
-        // steps per sq second need to be updated to agree with the units per sq second (as they are what is used in the planner)
-		reset_acceleration_rates();
-
-        EEPROM_READ_VAR(i,acceleration);
-        EEPROM_READ_VAR(i,retract_acceleration);
-        EEPROM_READ_VAR(i,minimumfeedrate);
-        EEPROM_READ_VAR(i,mintravelfeedrate);
-        EEPROM_READ_VAR(i,minsegmenttime);
-        EEPROM_READ_VAR(i,max_xy_jerk);
-        EEPROM_READ_VAR(i,max_z_jerk);
-        EEPROM_READ_VAR(i,max_e_jerk);
-        EEPROM_READ_VAR(i,add_homeing);
-        #ifdef DELTA
-        EEPROM_READ_VAR(i,endstop_adj);
+        #ifndef PIDTEMPVAT
+        float vatKp,vatKi,vatKd;
         #endif
-        #ifdef LASER
-        //EEPROM_READ_VAR(i,laser.lifetime);
+        EEPROM_READ_VAR(i,vatKp);
+        EEPROM_READ_VAR(i,vatKi);
+        EEPROM_READ_VAR(i,vatKd);
+        #ifndef VAT_EXPOSURE_COMPENSATION
+        uint8_t vat_exposure_mode;
         #endif
-        #ifndef ULTIPANEL
+        EEPROM_READ_VAR(i,vat_exposure_mode);
+    }
+    else
+    #endif
+    {
+        #if !defined(ULTIPANEL) || defined(LASER_ONLY)
         int plaPreheatHotendTemp, plaPreheatHPBTemp, plaPreheatFanSpeed;
         int absPreheatHotendTemp, absPreheatHPBTemp, absPreheatFanSpeed;
         #endif
@@ -234,20 +602,111 @@ void Config_RetrieveSettings()
         #ifndef PIDTEMP
         float Kp,Ki,Kd;
         #endif
-        // do not need to scale PID values as the values in EEPROM are already scaled
         EEPROM_READ_VAR(i,Kp);
         EEPROM_READ_VAR(i,Ki);
         EEPROM_READ_VAR(i,Kd);
-        #ifndef DOGLCD
-        int lcd_contrast;
+    }
+    #ifdef LASER_CALIBRATION
+    if (!v10)
+    {
+        EEPROM_READ_VAR(i,laser_calibration);
+        laser_calibration_check();
+    }
+    #endif
+    #ifndef DOGLCD
+    int lcd_contrast;
+    #endif
+    EEPROM_READ_VAR(i,lcd_contrast);
+    #if !defined(LASER) || defined(PIDTEMPVAT)
+    updatePID();
+    #endif
+    return true;
+}
+
+void Config_RetrieveSettings()
+{
+    if (Config_FindRecord())
+    {
+        // Settings missing from the record, e.g. added by a newer firmware, keep their defaults
+        Config_Defaults();
+        eeprom_missing_fields = 0;
+        EEPROM_READ_FIELD(EEPROM_STEPS_PER_UNIT,axis_steps_per_unit);
+        EEPROM_READ_FIELD(EEPROM_MAX_FEEDRATE,max_feedrate);
+        EEPROM_READ_FIELD(EEPROM_MAX_ACCELERATION,max_acceleration_units_per_sq_second);
+        EEPROM_READ_FIELD(EEPROM_ACCELERATION,acceleration);
+        EEPROM_READ_FIELD(EEPROM_RETRACT_ACCELERATION,retract_acceleration);
+
+        // steps per sq second need to be updated to agree with the units per sq second (as they are what is used in the planner)
+		reset_acceleration_rates();
+
+        EEPROM_READ_FIELD(EEPROM_MINIMUMFEEDRATE,minimumfeedrate);
+        EEPROM_READ_FIELD(EEPROM_MINTRAVELFEEDRATE,mintravelfeedrate);
+        EEPROM_READ_FIELD(EEPROM_MINSEGMENTTIME,minsegmenttime);
+        EEPROM_READ_FIELD(EEPROM_MAX_XY_JERK,max_xy_jerk);
+        EEPROM_READ_FIELD(EEPROM_MAX_Z_JERK,max_z_jerk);
+        EEPROM_READ_FIELD(EEPROM_MAX_E_JERK,max_e_jerk);
+        #ifdef JUNCTION_DEVIATION
+        EEPROM_READ_FIELD(EEPROM_JUNCTION_DEVIATION,junction_deviation);
+        #endif
+        EEPROM_READ_FIELD(EEPROM_ADD_HOMEING,add_homeing);
+        #ifdef DELTA
+        EEPROM_READ_FIELD(EEPROM_ENDSTOP_ADJ,endstop_adj);
+        #endif
+        #if defined(ULTIPANEL) && !defined(LASER_ONLY)
+        EEPROM_READ_FIELD(EEPROM_PLA_PREHEAT_HOTEND_TEMP,plaPreheatHotendTemp);
+        EEPROM_READ_FIELD(EEPROM_PLA_PREHEAT_HPB_TEMP,plaPreheatHPBTemp);
+        EEPROM_READ_FIELD(EEPROM_PLA_PREHEAT_FAN_SPEED,plaPreheatFanSpeed);
+        EEPROM_READ_FIELD(EEPROM_ABS_PREHEAT_HOTEND_TEMP,absPreheatHotendTemp);
+        EEPROM_READ_FIELD(EEPROM_ABS_PREHEAT_HPB_TEMP,absPreheatHPBTemp);
+        EEPROM_READ_FIELD(EEPROM_ABS_PREHEAT_FAN_SPEED,absPreheatFanSpeed);
         #endif
-        EEPROM_READ_VAR(i,lcd_contrast);
-        #ifndef LASER
+        #ifdef PIDTEMP
+        // do not need to scale PID values as the values in EEPROM are already scaled
+        EEPROM_READ_FIELD(EEPROM_KP,Kp);
+        EEPROM_READ_FIELD(EEPROM_KI,Ki);
+        EEPROM_READ_FIELD(EEPROM_KD,Kd);
+        #endif
+        #ifdef PIDTEMPVAT
+        EEPROM_READ_FIELD(EEPROM_VAT_KP,vatKp);
+        EEPROM_READ_FIELD(EEPROM_VAT_KI,vatKi);
+        EEPROM_READ_FIELD(EEPROM_VAT_KD,vatKd);
+        #endif
+        #ifdef VAT_EXPOSURE_COMPENSATION
+        EEPROM_READ_FIELD(EEPROM_VAT_EXPOSURE_MODE,vat_exposure_mode);
+        #endif
+        #ifdef LASER_CALIBRATION
+        EEPROM_READ_FIELD(EEPROM_LASER_CALIBRATION,laser_calibration);
+        laser_calibration_check();
+        #endif
+        #ifdef DOGLCD
+        EEPROM_READ_FIELD(EEPROM_LCD_CONTRAST,lcd_contrast);
+        #endif
+        #ifdef XY_CORRECTION
+        EEPROM_READ_FIELD(EEPROM_XY_CORRECTION,xy_correction);
+        reset_xy_correction();
+        #endif
+        #ifdef PLATE_TILT_COMPENSATION
+        EEPROM_READ_FIELD(EEPROM_PLATE_TILT,plate_tilt);
+        reset_plate_tilt();
+        #endif
+        #if !defined(LASER) || defined(PIDTEMPVAT)
 		// Call updatePID (similar to when we have processed M301)
 		updatePID();
         #endif
         SERIAL_ECHO_START;
         SERIAL_ECHOLNPGM("Stored settings retrieved");
+        if (eeprom_missing_fields)
+        {
+            SERIAL_ECHO_START;
+            SERIAL_ECHOPAIR("Settings not in EEPROM, defaults used: ",(unsigned long)eeprom_missing_fields);
+            SERIAL_ECHOLN("");
+        }
+    }
+    else if (Config_ImportFlatRecord())
+    {
+        SERIAL_ECHO_START;
+        SERIAL_ECHOLNPGM("Settings of the old EEPROM layout imported");
+        Config_StoreRecord();
     }
     else
     {
@@ -259,7 +718,7 @@ void Config_RetrieveSettings()
 }
 #endif
 
-void Config_ResetDefault()
+static void Config_Defaults()
 {
     float tmp1[]=DEFAULT_AXIS_STEPS_PER_UNIT;
     float tmp2[]=DEFAULT_MAX_FEEDRATE;
@@ -271,22 +730,37 @@ void Config_ResetDefault()
         max_acceleration_units_per_sq_second[i]=tmp3[i];
     }
 
+    acceleration=DEFAULT_ACCELERATION;
+    retract_acceleration=DEFAULT_RETRACT_ACCELERATION;
+#ifdef XY_CORRECTION
+    memset(xy_correction, 0, sizeof(xy_correction));
+#endif
+#ifdef PLATE_TILT_COMPENSATION
+    float tmp4[3][2] = PLATE_TILT_POINTS;
+    for (short p=0;p<3;p++) {
+        plate_tilt[p][X_AXIS]=tmp4[p][0];
+        plate_tilt[p][Y_AXIS]=tmp4[p][1];
+        plate_tilt[p][Z_AXIS]=0;
+    }
+#endif
+
     // steps per sq second need to be updated to agree with the units per sq second
     reset_acceleration_rates();
 
-    acceleration=DEFAULT_ACCELERATION;
-    retract_acceleration=DEFAULT_RETRACT_ACCELERATION;
     minimumfeedrate=DEFAULT_MINIMUMFEEDRATE;
     minsegmenttime=DEFAULT_MINSEGMENTTIME;
     mintravelfeedrate=DEFAULT_MINTRAVELFEEDRATE;
     max_xy_jerk=DEFAULT_XYJERK;
     max_z_jerk=DEFAULT_ZJERK;
     max_e_jerk=DEFAULT_EJERK;
+#ifdef JUNCTION_DEVIATION
+    junction_deviation=DEFAULT_JUNCTION_DEVIATION;
+#endif
     add_homeing[0] = add_homeing[1] = add_homeing[2] = 0;
 #ifdef DELTA
     endstop_adj[0] = endstop_adj[1] = endstop_adj[2] = 0;
 #endif
-#ifdef ULTIPANEL
+#if defined(ULTIPANEL) && !defined(LASER_ONLY)
     plaPreheatHotendTemp = PLA_PREHEAT_HOTEND_TEMP;
     plaPreheatHPBTemp = PLA_PREHEAT_HPB_TEMP;
     plaPreheatFanSpeed = PLA_PREHEAT_FAN_SPEED;
@@ -309,8 +783,23 @@ void Config_ResetDefault()
     Kc = DEFAULT_Kc;
 #endif//PID_ADD_EXTRUSION_RATE
 #endif//PIDTEMP
+#ifdef PIDTEMPVAT
+    vatKp = DEFAULT_vatKp;
+    vatKi = scalePID_i(DEFAULT_vatKi);
+    vatKd = scalePID_d(DEFAULT_vatKd);
+    updatePID();
+#endif//PIDTEMPVAT
+#ifdef VAT_EXPOSURE_COMPENSATION
+    vat_exposure_mode = VAT_EXPOSURE_MODE;
+#endif
+#ifdef LASER_CALIBRATION
+    laser_calibration_reset();
+#endif
+}
 
-SERIAL_ECHO_START;
-SERIAL_ECHOLNPGM("Hardcoded Default Settings Loaded");
-
+void Config_ResetDefault()
+{
+    Config_Defaults();
+    SERIAL_ECHO_START;
+    SERIAL_ECHOLNPGM("Hardcoded Default Settings Loaded");
 }
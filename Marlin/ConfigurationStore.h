@@ -3,6 +3,16 @@
 
 #include "Configuration.h"
 
+// Writes size bytes at EEPROM address pos and moves pos past them. Only the bytes that differ are written.
+void _EEPROM_writeData(int &pos, uint8_t* value, uint8_t size);
+#ifdef EEPROM_BACKGROUND_WRITES
+bool eeprom_write_pending();
+void eeprom_write_flush();
+#else
+FORCE_INLINE bool eeprom_write_pending() { return false; }
+FORCE_INLINE void eeprom_write_flush() {}
+#endif
+
 void Config_ResetDefault();
 
 #ifndef DISABLE_M503
@@ -14,6 +24,9 @@ FORCE_INLINE void Config_PrintSettings() {}
 #ifdef EEPROM_SETTINGS
 void Config_StoreSettings();
 void Config_RetrieveSettings();
+#ifdef EEPROM_BACKGROUND_WRITES
+void Config_ReportStored();
+#endif
 #else
 FORCE_INLINE void Config_StoreSettings() {}
 FORCE_INLINE void Config_RetrieveSettings() { Config_ResetDefault(); Config_PrintSettings(); }
@@ -84,6 +84,13 @@
 
 #define ENDSTOPS_ONLY_FOR_HOMING // If defined the endstops will only be used for homing
 
+// Read the endstops from pin change and external interrupts instead of on every stepper interrupt. The
+// interrupts are only on while the endstops are enabled (the homing moves with ENDSTOPS_ONLY_FOR_HOMING), a hit
+// latches count_position and ends the block. An endstop that is already pressed is found when the block starts.
+// Needs an ATmega1280/2560. An endstop on a pin without an external or pin change interrupt is still polled by
+// the stepper interrupt. See simulate_endstops.py.
+#define ENDSTOP_INTERRUPTS
+
 
 //// AUTOSET LOCATIONS OF LIMIT SWITCHES
 //// Added by ZetaPhoenix 09-15-2012
@@ -199,10 +206,30 @@
 #define Z_HOME_RETRACT_MM 1 
 #define QUICK_HOME  //if this is defined, if both x and y are to be homed, a diagonal move will be performed initially.
 
+// Home in two phases. The fast approach latches the step where the endstop triggered, the axis backs off to
+// HOMING_BUMP_MM before that step and comes back at the homing feedrate / HOMING_BUMP_DIVISOR. Home is the step
+// latched on the slow approach, however far the axis ran on after it. X and Y home together, QUICK_HOME and
+// *_HOME_RETRACT_MM are not used. M657 measures the repeatability.
+#define TWO_PHASE_HOMING
+#ifdef TWO_PHASE_HOMING
+  #define HOMING_BUMP_MM {1, 1, 0.5}       // (mm) X, Y, Z
+  #define HOMING_BUMP_DIVISOR {5, 5, 5}    // slow approach feedrate = homing feedrate / divisor
+#endif
+
 #define AXIS_RELATIVE_MODES {false, false, false, false}
 
 #define MAX_STEP_FREQUENCY 40000 // Max step frequency for Ultimaker (5000 pps / half step)
 
+// Above MAX_STEP_ISR_FREQUENCY the stepper interrupt takes several steps per call. With ADAPTIVE_STEP_LOOPS
+// it takes 1, 2, 3, 4 or 8, the fewest that keep it under that frequency, instead of jumping from 1 to 2 to 4
+// at 10 and 20kHz. Fewer steps per call means the steps are spaced more evenly. It only takes fewer again once
+// the rate has dropped STEP_LOOPS_HYSTERESIS percent below the switch point, so hatch lines running close to it
+// don't flip between two settings from one block to the next. The setting for the nominal rate of each block
+// is chosen when it is planned.
+#define ADAPTIVE_STEP_LOOPS
+#define MAX_STEP_ISR_FREQUENCY 10000
+#define STEP_LOOPS_HYSTERESIS 5
+
 //By default pololu step drivers require an active high signal. However, some high power drivers require an active low signal as step.
 #define INVERT_X_STEP_PIN false
 #define INVERT_Y_STEP_PIN false
@@ -236,6 +263,24 @@
 // if unwanted behavior is observed on a user's machine when running at very slow speeds.
 #define MINIMUM_PLANNER_SPEED 0.05// (mm/sec)
 
+// S-curve acceleration. The speed ramps follow a quintic Bezier curve instead of a straight line, so the
+// acceleration builds up and dies down smoothly instead of switching on and off at the ends of each ramp.
+// That keeps light gantries from ringing. The ramps take as long as the linear ones, but the peak acceleration
+// in the middle is 1.875 times the set one, lower the acceleration accordingly if the motors are close to stalling.
+//#define S_CURVE_ACCELERATION
+
+// Apply changes of the feedrate override (M220, the LCD) to the moves already in the look ahead buffer
+// instead of only to the ones queued after it. Only moves with X or Y motion are rescaled, like when they
+// are queued, and never beyond the max feedrates. The stepper may already be running the first two blocks,
+// those keep their speed.
+#define LIVE_FEEDRATE_OVERRIDE
+
+// Plan the length, speed and acceleration limits of each move with integer math instead of soft float. The
+// step counts are scaled to 16 bits, the length comes from an integer square root and the per axis limits
+// are found with 16x16 bit multiplies, so a block takes one or two float divides instead of a dozen. Lengths
+// are within 0.02% of the float ones. simulate_fixed_planner.py compares both and counts the cycles.
+#define FIXED_POINT_PLANNER
+
 // MS1 MS2 Stepper Driver Microstepping mode table
 #define MICROSTEP1 LOW,LOW
 #define MICROSTEP2 HIGH,LOW
@@ -257,6 +302,21 @@
 #define SD_FINISHED_STEPPERRELEASE true  //if sd support and the file is finished: disable steppers?
 #define SD_FINISHED_RELEASECOMMAND "M84 X Y Z E" // You might want to keep the z enabled so your bed stays in place.
 
+// Binary layer jobs: files starting with the "MUVB" header are fed straight into the planner
+// instead of being parsed as G-code. Use create_binary_job.py to convert sliced G-code.
+// Records carry fixed point XY endpoints, feedrate, laser on/off/intensity and layer markers,
+// anything else is passed through as an embedded G-code line.
+#define SD_BINARY_JOBS
+
+// Estimate the time left of an SD print. The planner adds up the time of every move from its trapezoid, and
+// each layer (from the first XY move at a new Z to the next) adds its planned time per file byte and how much
+// longer it really took than planned to running averages. The time left is the moves in the buffer plus the
+// rest of the file at the average, scaled by that factor. M27 reports it with the layer and the average layer
+// time, the status screen clock shows it ('R', hh:mm) and the layer time ('L', mm:ss) in turn with the
+// elapsed time.
+#define PRINT_PROGRESS
+#define PRINT_PROGRESS_LAYERS 4 // A new layer weighs 1/PRINT_PROGRESS_LAYERS in the averages, at most 255
+
 // The hardware watchdog should reset the Microcontroller disabling all outputs, in case the firmware gets stuck and doesn't do temperature regulation.
 //#define USE_WATCHDOG
 
@@ -289,10 +349,34 @@
 
 #endif // ADVANCE
 
+// Join consecutive G0/G1 moves in the XY plane into one planner block when they go on in the same direction
+// with the same feedrate, E per mm and laser settings, and every joint stays within SEGMENT_COALESCING_TOLERANCE
+// mm of the joined move. Slicers cut long hatch lines into many pieces, this saves the blocks and the speed
+// dips at the joints. The last move is held back until one comes that doesn't fit, any other command comes
+// or the command buffer runs empty.
+//#define SEGMENT_COALESCING
+#define SEGMENT_COALESCING_TOLERANCE 0.005
+#define SEGMENT_COALESCING_MAX_LENGTH 100
+
 // Arc interpretation settings:
 #define MM_PER_ARC_SEGMENT 1
 #define N_ARC_CORRECTION 25
 
+// With ARC_CHORD_TOLERANCE the arcs are cut into chords that stay within that many mm of the true arc
+// instead of MM_PER_ARC_SEGMENT long ones, small circles get more segments and big arcs fewer. The chords
+// are kept between MIN_MM_PER_ARC_SEGMENT and MAX_MM_PER_ARC_SEGMENT long.
+#define ARC_CHORD_TOLERANCE 0.005
+#define MIN_MM_PER_ARC_SEGMENT 0.05
+#define MAX_MM_PER_ARC_SEGMENT 10
+
+// G5 I<x> J<y> P<x> Q<y> X<x> Y<y> moves along a cubic Bezier curve to X Y. The first control point is
+// at I J from the start, the second at P Q from the end. The curve is halved until each piece is within
+// BEZIER_TOLERANCE mm of a straight line, at most BEZIER_MAX_DEPTH times (2^BEZIER_MAX_DEPTH lines). Each level
+// costs 25 bytes of stack. Curves of 20-100mm need 7-8 levels for 0.005mm.
+#define BEZIER_CURVE_SUPPORT
+#define BEZIER_TOLERANCE 0.005
+#define BEZIER_MAX_DEPTH 8
+
 const unsigned int dropsegments=1; //everything with less than this number of steps will be ignored as move and joined with the next movement
 
 // If you are using a RAMPS board or cheap E-bay purchased boards that do not detect when an SD card is inserted
@@ -368,6 +452,78 @@ const unsigned int dropsegments=1; //everything with less than this number of st
   #error "You cannot use TEMP_SENSOR_1_AS_REDUNDANT if EXTRUDERS > 1"
 #endif
 
+#if defined(LASER_CONSTANT_ENERGY) && LASER_CONTROL != 1
+  #error "LASER_CONSTANT_ENERGY is for continuous firing, LASER_CONTROL 1"
+#endif
+
+#if defined(SEGMENT_COALESCING) && (defined(DELTA) || defined(DUAL_X_CARRIAGE))
+  #error "SEGMENT_COALESCING only works with the cartesian moves of prepare_move()"
+#endif
+
+#if defined(XY_CORRECTION) && (defined(DELTA) || XY_CORRECTION_POINTS_X < 2 || XY_CORRECTION_POINTS_Y < 2)
+  #error "XY_CORRECTION needs a cartesian machine and at least 2 points along X and Y"
+#endif
+#if defined(XY_CORRECTION) && XY_CORRECTION_POINTS_X * XY_CORRECTION_POINTS_Y > 63
+  #error "The XY correction map is one EEPROM field of up to 255 bytes, use at most 63 points"
+#endif
+
+#if defined(PRINT_PROGRESS) && !defined(SDSUPPORT)
+  #error "PRINT_PROGRESS estimates SD prints, it needs SDSUPPORT"
+#endif
+
+#if defined(ST7920_HARDWARE_SPI) && (!defined(U8GLIB_ST7920) || (!defined(__AVR_ATmega1280__) && !defined(__AVR_ATmega2560__)))
+  #error "ST7920_HARDWARE_SPI needs the ST7920 graphic LCD on an ATmega1280 or ATmega2560"
+#endif
+
+#ifdef ENDSTOP_INTERRUPTS
+  #if !defined(__AVR_ATmega1280__) && !defined(__AVR_ATmega2560__)
+    #error "ENDSTOP_INTERRUPTS needs an ATmega1280 or ATmega2560"
+  #endif
+  #if defined(COREXY) || defined(DUAL_X_CARRIAGE)
+    #error "ENDSTOP_INTERRUPTS does not support COREXY or DUAL_X_CARRIAGE"
+  #endif
+#endif
+
+#if defined(TWO_PHASE_HOMING) && (defined(DELTA) || defined(DUAL_X_CARRIAGE) || defined(SERVO_ENDSTOPS))
+  #error "TWO_PHASE_HOMING does not support DELTA, DUAL_X_CARRIAGE or SERVO_ENDSTOPS"
+#endif
+
+#if defined(PLATE_TILT_COMPENSATION) && defined(DELTA)
+  #error "PLATE_TILT_COMPENSATION needs a cartesian machine"
+#endif
+
+#if defined(LASER_LIFETIME) && !defined(LASER)
+  #error "LASER_LIFETIME needs LASER"
+#endif
+
+#ifdef LASER_ONLY
+  #ifndef LASER
+    #error "LASER_ONLY needs LASER"
+  #endif
+  #if TEMP_SENSOR_0 != 0 || TEMP_SENSOR_1 != 0 || TEMP_SENSOR_2 != 0 || TEMP_SENSOR_BED != 0
+    #error "LASER_ONLY has no heaters, set TEMP_SENSOR_0, TEMP_SENSOR_1, TEMP_SENSOR_2 and TEMP_SENSOR_BED to 0"
+  #endif
+  #if LASER_TEMP_SENSOR < 0 || VAT_TEMP_SENSOR < 0
+    #error "The laser and vat monitor only supports thermistors"
+  #endif
+  #if LASER_TEMP_SENSOR > 0
+    #define THERMISTORLASER LASER_TEMP_SENSOR
+  #endif
+  #if VAT_TEMP_SENSOR > 0
+    #define THERMISTORVAT VAT_TEMP_SENSOR
+  #endif
+  // Everything below needs a hotend
+  #undef PIDTEMP
+  #undef PIDTEMPBED
+  #undef AUTOTEMP
+  #undef WATCH_TEMP_PERIOD
+  #undef PREVENT_DANGEROUS_EXTRUDE
+  #undef PREVENT_LENGTHY_EXTRUDE
+  #undef EXTRUDER_RUNOUT_PREVENT
+  #undef TEMP_SENSOR_1_AS_REDUNDANT
+  #undef FAN_SOFT_PWM
+#endif
+
 #if TEMP_SENSOR_0 > 0
   #define THERMISTORHEATER_0 TEMP_SENSOR_0
   #define HEATER_0_USES_THERMISTOR
@@ -175,6 +175,13 @@ bool IsStopped();
 void enquecommand(const char *cmd); //put an ascii command at the end of the current buffer.
 void enquecommand_P(const char *cmd); //put an ascii command at the end of the current buffer, read from flash
 void prepare_arc_move(char isclockwise);
+#ifdef SEGMENT_COALESCING
+void flush_coalesced_move(); // Plan the move held back to join the next ones to
+void discard_coalesced_move();
+#endif
+#ifdef BEZIER_CURVE_SUPPORT
+void prepare_bezier_move(float *control);
+#endif
 void clamp_to_software_endstops(float target[3]);
 
 #ifdef FAST_PWM_FAN
@@ -218,6 +225,13 @@ extern float retract_recover_length, retract_recover_feedrate;
 extern unsigned long starttime;
 extern unsigned long stoptime;
 
+#ifdef PRINT_PROGRESS
+void print_progress_start(); // an SD print starts or resumes
+long print_time_remaining(); // (s) estimated, -1 without an estimate
+long print_layer_time(); // (s) the average layer, -1 without an estimate
+char print_progress_clock(uint16_t &time);
+#endif
+
 // Handling multiple extruders pins
 extern uint8_t active_extruder;
 
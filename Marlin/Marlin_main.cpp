@@ -60,6 +60,7 @@
 // G2  - CW ARC
 // G3  - CCW ARC
 // G4  - Dwell S<seconds> or P<milliseconds>
+// G5  - Cubic Bezier I<x> J<y> P<x> Q<y> X<x> Y<y>, control points relative to the start and the end
 // G10 - retract filament according to settings of M207
 // G11 - retract recover filament according to settings of M208
 // G28 - Home all Axis
@@ -116,7 +117,7 @@
 // M202 - Set max acceleration in units/s^2 for travel moves (M202 X1000 Y1000) Unused in Marlin!!
 // M203 - Set maximum feedrate that your machine can sustain (M203 X200 Y200 Z300 E10000) in mm/sec
 // M204 - Set default acceleration: S normal moves T filament only moves (M204 S3000 T7000) im mm/sec^2  also sets minimum segment time in ms (B20000) to prevent buffer underruns and M20 minimum feedrate
-// M205 -  advanced settings:  minimum travel speed S=while printing T=travel only,  B=minimum segment time X= maximum xy jerk, Z=maximum Z jerk, E=maximum E jerk
+// M205 -  advanced settings:  minimum travel speed S=while printing T=travel only,  B=minimum segment time X= maximum xy jerk, Z=maximum Z jerk, E=maximum E jerk, J=junction deviation (0 = use the jerk limits)
 // M206 - set additional homeing offset
 // M207 - set retract length S[positive mm] F[feedrate mm/sec] Z[additional zlift/hop]
 // M208 - set recover=unretract length S[positive mm surplus to the M207 S*] F[feedrate mm/sec]
@@ -131,7 +132,7 @@
 // M301 - Set PID parameters P I and D
 // M302 - Allow cold extrudes, or set the minimum extrude S<temperature>.
 // M303 - PID relay autotune S<temperature> sets the target temperature. (default target temperature = 150C)
-// M304 - Set bed PID parameters P I and D
+// M304 - Set bed PID parameters P I and D (vat PID with LASER_ONLY)
 // M400 - Finish all moves
 // M500 - stores paramters in EEPROM
 // M501 - reads parameters from EEPROM (if you need reset them after you changed them temporarily).
@@ -268,6 +269,16 @@ bool target_direction;
 
 void get_arc_coordinates();
 bool setTargetedHotend(int code);
+#ifdef SDSUPPORT
+static void sd_print_finished();
+#endif
+#ifdef SD_BINARY_JOBS
+static void get_binary_command();
+#endif
+#ifdef PRINT_PROGRESS
+static void print_progress_layer();
+static void print_progress_report();
+#endif
 
 void serial_echopair_P(const char *s_P, float v)
     { serialprintPGM(s_P); SERIAL_ECHO(v); }
@@ -436,7 +447,7 @@ void setup()
   // loads data from EEPROM if available else uses defaults (and resets step acceleration rate)
   Config_RetrieveSettings();
 
-  #ifndef LASER
+  #if !defined(LASER) || defined(LASER_ONLY)
   tp_init();    // Initialize temperature loop
   #endif
   plan_init();  // Initialize planner;
@@ -498,15 +509,24 @@ void loop()
     buflen = (buflen-1);
     bufindr = (bufindr + 1)%BUFSIZE;
   }
+  #ifdef SEGMENT_COALESCING
+  // Nothing more to join the held back move to for now
+  if(buflen == 0)
+    flush_coalesced_move();
+  #endif
   //check heater every n milliseconds
-  #ifndef LASER
+  #if !defined(LASER) || defined(LASER_ONLY)
   manage_heater();
   #endif
   manage_inactivity();
   #ifdef ENDSTOPS_ONLY_FOR_HOMING
   checkHitEndstops();
   #endif
+  checkStepperErrors();
   lcd_update();
+  #ifdef LIVE_FEEDRATE_OVERRIDE
+  plan_apply_feedmultiply();
+  #endif
 }
 
 void get_command()
@@ -588,6 +608,9 @@ void get_command()
           case 1:
           case 2:
           case 3:
+          #ifdef BEZIER_CURVE_SUPPORT
+          case 5:
+          #endif
             if(Stopped == false) { // If printer is stopped by an error the G[0-3] codes are ignored.
           #ifdef SDSUPPORT
               if(card.saving)
@@ -620,6 +643,12 @@ void get_command()
   if(!card.sdprinting || serial_count!=0){
     return;
   }
+  #ifdef SD_BINARY_JOBS
+  if(card.binaryjob){
+    get_binary_command();
+    return;
+  }
+  #endif
   while( !card.eof()  && buflen < BUFSIZE) {
     int16_t n=card.get();
     serial_char = (char)n;
@@ -629,20 +658,7 @@ void get_command()
        serial_count >= (MAX_CMD_SIZE - 1)||n==-1)
     {
       if(card.eof()){
-        SERIAL_PROTOCOLLNPGM(MSG_FILE_PRINTED);
-        stoptime=millis();
-        char time[30];
-        unsigned long t=(stoptime-starttime)/1000;
-        int hours, minutes;
-        minutes=(t/60)%60;
-        hours=t/60/60;
-        sprintf_P(time, PSTR("%i hours %i minutes"),hours, minutes);
-        SERIAL_ECHO_START;
-        SERIAL_ECHOLN(time);
-        lcd_setstatus(time);
-        card.printingHasFinished();
-        card.checkautostart(true);
-
+        sd_print_finished();
       }
       if(!serial_count)
       {
@@ -669,6 +685,277 @@ void get_command()
 
 }
 
+#ifdef SDSUPPORT
+static void sd_print_finished()
+{
+  #ifdef SEGMENT_COALESCING
+  // The last move may still be held back, binary jobs don't go through process_commands()
+  flush_coalesced_move();
+  #endif
+  SERIAL_PROTOCOLLNPGM(MSG_FILE_PRINTED);
+  stoptime=millis();
+  char time[30];
+  unsigned long t=(stoptime-starttime)/1000;
+  int hours, minutes;
+  minutes=(t/60)%60;
+  hours=t/60/60;
+  sprintf_P(time, PSTR("%i hours %i minutes"),hours, minutes);
+  SERIAL_ECHO_START;
+  SERIAL_ECHOLN(time);
+  lcd_setstatus(time);
+  card.printingHasFinished();
+  card.checkautostart(true);
+}
+#endif //SDSUPPORT
+
+#ifdef SD_BINARY_JOBS
+// E is moved by e_delta from where it is, so LASER_FIRE_E sees the E moves of the sliced job
+static void binary_move(long *position, long e_delta)
+{
+  destination[X_AXIS] = (float)position[X_AXIS] / card.binary_units_per_mm;
+  destination[Y_AXIS] = (float)position[Y_AXIS] / card.binary_units_per_mm;
+  destination[Z_AXIS] = (float)position[Z_AXIS] / card.binary_units_per_mm;
+  destination[E_AXIS] = current_position[E_AXIS] + (float)e_delta / card.binary_units_per_mm;
+  prepare_move();
+}
+
+static void binary_job_error()
+{
+  SERIAL_ERROR_START;
+  SERIAL_ERRORLNPGM("Corrupt binary job, print stopped");
+  LCD_MESSAGEPGM("Err: binary job");
+  #ifdef LASER
+  laser.status = LASER_OFF;
+  #endif
+  card.sdprinting = false;
+  card.closefile();
+}
+
+// Binary layer jobs skip the G-code parser: every record is decoded straight into
+// destination[] and handed to prepare_move(). Embedded G-code records still go through
+// the command buffer, so records are only read while that buffer is empty to keep file order.
+// Reading stops when the planner is full, so plan_buffer_line() never blocks in here.
+static void get_binary_command()
+{
+  long position[3]; // current endpoint, in file units
+  uint8_t op;
+  union {
+    struct { int16_t x, y; } rel;
+    struct { int32_t x, y; } abs;
+    struct { int16_t x, y, e; } rel_e;
+    struct { int32_t x, y, e; } abs_e;
+    int32_t z;
+    int32_t e;
+    uint16_t value;
+    uint8_t length;
+  } arg;
+
+  // Embedded G-code (G28, G92, ...) may have moved us, so always continue from current_position.
+  for(int8_t i=0; i < 3; i++)
+    position[i] = lround(current_position[i] * card.binary_units_per_mm);
+
+  while(buflen == 0 && !card.eof() && movesplanned() < BLOCK_BUFFER_SIZE - 1 && Stopped == false)
+  {
+    if(!card.read(&op, sizeof(op))) break;
+    switch(op)
+    {
+    case BJ_MOVE_REL:
+      if(!card.read(&arg.rel, sizeof(arg.rel))) { binary_job_error(); return; }
+      position[X_AXIS] += arg.rel.x;
+      position[Y_AXIS] += arg.rel.y;
+      binary_move(position, 0);
+      break;
+    case BJ_MOVE_ABS:
+      if(!card.read(&arg.abs, sizeof(arg.abs))) { binary_job_error(); return; }
+      position[X_AXIS] = arg.abs.x;
+      position[Y_AXIS] = arg.abs.y;
+      binary_move(position, 0);
+      break;
+    case BJ_MOVE_REL_E:
+      if(!card.read(&arg.rel_e, sizeof(arg.rel_e))) { binary_job_error(); return; }
+      position[X_AXIS] += arg.rel_e.x;
+      position[Y_AXIS] += arg.rel_e.y;
+      binary_move(position, arg.rel_e.e);
+      break;
+    case BJ_MOVE_ABS_E:
+      if(!card.read(&arg.abs_e, sizeof(arg.abs_e))) { binary_job_error(); return; }
+      position[X_AXIS] = arg.abs_e.x;
+      position[Y_AXIS] = arg.abs_e.y;
+      binary_move(position, arg.abs_e.e);
+      break;
+    case BJ_MOVE_E:
+      if(!card.read(&arg.e, sizeof(arg.e))) { binary_job_error(); return; }
+      binary_move(position, arg.e);
+      break;
+    case BJ_FEEDRATE:
+      if(!card.read(&arg.value, sizeof(arg.value))) { binary_job_error(); return; }
+      if(arg.value > 0) feedrate = arg.value;
+      break;
+    case BJ_MOVE_Z:
+      if(!card.read(&arg.z, sizeof(arg.z))) { binary_job_error(); return; }
+      position[Z_AXIS] = arg.z;
+      binary_move(position, 0);
+      break;
+    #ifdef LASER
+    case BJ_LASER_ON:
+      if(!card.read(&arg.value, sizeof(arg.value))) { binary_job_error(); return; }
+      laser.intensity = arg.value / 100.0;
+      laser_pulse_init();
+      laser.status = LASER_ON;
+      #ifdef LASER_FIRE_SPINDLE
+      laser.fired = LASER_FIRE_SPINDLE;
+      #endif
+      break;
+    case BJ_LASER_OFF:
+      laser.status = LASER_OFF;
+      break;
+    #endif // LASER
+    case BJ_LAYER:
+      if(!card.read(&arg.value, sizeof(arg.value))) { binary_job_error(); return; }
+      SERIAL_ECHO_START;
+      SERIAL_ECHOPGM("Layer:");
+      SERIAL_ECHOLN(arg.value);
+      break;
+    case BJ_GCODE:
+      if(!card.read(&arg.length, sizeof(arg.length)) || arg.length >= MAX_CMD_SIZE ||
+         !card.read(cmdbuffer[bufindw], arg.length)) { binary_job_error(); return; }
+      cmdbuffer[bufindw][arg.length] = 0;
+      fromsd[bufindw] = true;
+      buflen += 1;
+      bufindw = (bufindw + 1)%BUFSIZE;
+      break;
+    default:
+      binary_job_error();
+      return;
+    }
+  }
+  if(card.eof())
+    sd_print_finished();
+}
+#endif //SD_BINARY_JOBS
+
+#ifdef PRINT_PROGRESS
+// The planner adds up the estimated time of the moves in planned_time, here it is reset for each layer. A layer
+// begins with the first XY move at a new Z. Each finished layer adds its planned time per file byte, its
+// planned time and its clock time to running averages, the clock time covers what the planner doesn't
+// see (dwells, waits, the exposure settling). A new layer weighs 1/PRINT_PROGRESS_LAYERS.
+static int progress_layer = 0;              // The layer being planned, 0 before the first one
+static uint8_t progress_layers_averaged = 0; // up to PRINT_PROGRESS_LAYERS
+static bool progress_layer_measured;        // The layer was planned from its start, not resumed
+static float progress_layer_z;
+static uint32_t progress_layer_pos;         // card.getIndex() and millis() at the start of the layer
+static unsigned long progress_layer_millis;
+static float progress_seconds_per_byte;     // Running averages
+static float progress_planned_per_layer;
+static float progress_clock_per_layer;
+
+// A resumed print goes on with its averages, the layer that was paused in is left out of them
+void print_progress_start()
+{
+  if (progress_layer == 0 || card.getIndex() < progress_layer_pos) {
+    progress_layer = 0;
+    progress_layers_averaged = 0;
+  }
+  progress_layer_measured = false;
+  planned_time = 0;
+}
+
+// Called by prepare_move() before the move is planned
+static void print_progress_layer()
+{
+  if (!card.sdprinting || (current_position[X_AXIS] == destination[X_AXIS] && current_position[Y_AXIS] == destination[Y_AXIS]))
+    return;
+  if (progress_layer != 0 && destination[Z_AXIS] == progress_layer_z)
+    return;
+  unsigned long now = millis();
+  float planned = planned_time;
+  uint32_t bytes = card.getIndex() - progress_layer_pos;
+  if (progress_layer_measured && planned > 0 && bytes > 0) {
+    // The first layers make a plain average
+    uint8_t weight = min(progress_layers_averaged + 1, PRINT_PROGRESS_LAYERS);
+    progress_seconds_per_byte += (planned / bytes - progress_seconds_per_byte) / weight;
+    progress_planned_per_layer += (planned - progress_planned_per_layer) / weight;
+    progress_clock_per_layer += ((now - progress_layer_millis) / 1000.0 - progress_clock_per_layer) / weight;
+    if (progress_layers_averaged < PRINT_PROGRESS_LAYERS)
+      progress_layers_averaged++;
+  }
+  progress_layer++;
+  progress_layer_measured = true;
+  progress_layer_z = destination[Z_AXIS];
+  planned_time = 0;
+  progress_layer_pos = card.getIndex();
+  progress_layer_millis = now;
+}
+
+// The moves in the buffer and the rest of the file at the average planned time per byte, scaled by how
+// much longer the layers took than planned. Until a layer is finished the one being planned is the guide.
+long print_time_remaining()
+{
+  if (!card.sdprinting)
+    return -1;
+  float seconds_per_byte;
+  float clock_per_planned = 1;
+  if (progress_layers_averaged > 0) {
+    seconds_per_byte = progress_seconds_per_byte;
+    clock_per_planned = progress_clock_per_layer / progress_planned_per_layer;
+  }
+  else if (progress_layer_measured && card.getIndex() > progress_layer_pos)
+    seconds_per_byte = planned_time / (card.getIndex() - progress_layer_pos);
+  else
+    return -1;
+  return (plan_queued_time() + (card.getFileSize() - card.getIndex()) * seconds_per_byte) * clock_per_planned;
+}
+
+long print_layer_time()
+{
+  if (!card.sdprinting || progress_layers_averaged == 0)
+    return -1;
+  return progress_clock_per_layer + 0.5;
+}
+
+// The status screen clock shows the elapsed time, the time left ('R') and the layer time ('L', in minutes
+// and seconds) in turn for 3 s each. time comes with the elapsed minutes, the label is 0 to show them.
+char print_progress_clock(uint16_t &time)
+{
+  long seconds;
+  switch ((millis() / 3000) % 3) {
+  case 1:
+    seconds = print_time_remaining();
+    if (seconds < 0)
+      return 0;
+    time = min(seconds / 60, 5999L);
+    return 'R';
+  case 2:
+    seconds = print_layer_time();
+    if (seconds < 0)
+      return 0;
+    time = min(seconds, 5999L);
+    return 'L';
+  }
+  return 0;
+}
+
+// M27 adds the layer, the average layer time and the time left (s) to the SD position
+static void print_progress_report()
+{
+  if (!card.sdprinting)
+    return;
+  long layer_time = print_layer_time();
+  long remaining = print_time_remaining();
+  SERIAL_PROTOCOLPGM("Layer:");
+  SERIAL_PROTOCOL(progress_layer);
+  if (layer_time >= 0) {
+    SERIAL_PROTOCOLPGM(" Layer time:");
+    SERIAL_PROTOCOL(layer_time);
+  }
+  if (remaining >= 0) {
+    SERIAL_PROTOCOLPGM(" Remaining:");
+    SERIAL_PROTOCOL(remaining);
+  }
+  SERIAL_PROTOCOLLN("");
+}
+#endif // PRINT_PROGRESS
+
 
 float code_value()
 {
@@ -769,10 +1056,11 @@ static void axis_is_at_home(int axis) {
   max_pos[axis] =          base_max_pos(axis) + add_homeing[axis];
 }
 
-static void homeaxis(int axis) {
 #define HOMEAXIS_DO(LETTER) \
   ((LETTER##_MIN_PIN > -1 && LETTER##_HOME_DIR==-1) || (LETTER##_MAX_PIN > -1 && LETTER##_HOME_DIR==1))
 
+#ifndef TWO_PHASE_HOMING
+static void homeaxis(int axis) {
   if (axis==X_AXIS ? HOMEAXIS_DO(X) :
       axis==Y_AXIS ? HOMEAXIS_DO(Y) :
       axis==Z_AXIS ? HOMEAXIS_DO(Z) :
@@ -856,11 +1144,161 @@ static void homeaxis(int axis) {
 }
 #define HOMEAXIS(LETTER) homeaxis(LETTER##_AXIS)
 
+#else // TWO_PHASE_HOMING
+
+static const float homing_bump_mm[3] = HOMING_BUMP_MM;
+static const float homing_bump_divisor[3] = HOMING_BUMP_DIVISOR;
+static const float homing_no_divisor[3] = { 1, 1, 1 };
+// How far (mm) the slow approach triggered from where the position before homing put home, see M657
+static float homing_error[3];
+
+// Takes current_position from the steppers, after a move that an endstop cut short
+static void homing_sync_position()
+{
+  plan_sync_position();
+  for(int8_t i=0; i < NUM_AXIS; i++)
+    destination[i] = current_position[i] = float(st_get_position(i)) / axis_steps_per_unit[i];
+}
+
+// Moves the axes of the mask by distance[] towards their endstops, each at its homing feedrate / divisor[].
+// The block stops at the first endstop, the other axes go on in the next move. The latched steps go into
+// trigger[], the axes that did not trigger are returned.
+static uint8_t homing_approach(uint8_t mask, const float *distance, const float *divisor, long *trigger)
+{
+  endstops_hit_on_purpose();
+  while(mask) {
+    homing_sync_position();
+    float length = 0, time = 0;
+    for(int8_t axis=X_AXIS; axis <= Z_AXIS; axis++) {
+      if(!(mask & (1<<axis))) continue;
+      destination[axis] += distance[axis] * home_dir(axis);
+      length += distance[axis] * distance[axis];
+      time = max(time, distance[axis] * divisor[axis] / homing_feedrate[axis]);
+    }
+    #ifdef MUVE_Z_PEEL
+      destination[E_AXIS] += destination[Z_AXIS] - current_position[Z_AXIS];
+    #endif
+    // The slowest axis at its feedrate
+    feedrate = sqrt(length) / time;
+    plan_buffer_line(destination[X_AXIS], destination[Y_AXIS], destination[Z_AXIS], destination[E_AXIS], feedrate/60, active_extruder);
+    st_synchronize();
+
+    uint8_t triggered = 0;
+    for(int8_t axis=X_AXIS; axis <= Z_AXIS; axis++)
+      if((mask & (1<<axis)) && endstop_trigger(axis, trigger[axis]))
+        triggered |= 1<<axis;
+    endstops_hit_on_purpose();
+    if(!triggered)
+      break;
+    mask &= ~triggered;
+  }
+  homing_sync_position();
+  return mask;
+}
+
+// Homes the axes of the mask together: the fast approach, back off to HOMING_BUMP_MM before the latched step
+// and the slow approach. Home is the step latched by the slow approach.
+static void home_axes(uint8_t mask)
+{
+  if(!HOMEAXIS_DO(X)) mask &= ~(1<<X_AXIS);
+  if(!HOMEAXIS_DO(Y)) mask &= ~(1<<Y_AXIS);
+  if(!HOMEAXIS_DO(Z)) mask &= ~(1<<Z_AXIS);
+  if(!mask)
+    return;
+
+  // Where the position before homing puts home, in steps, to measure the repeatability
+  float expected[3];
+  for(int8_t axis=X_AXIS; axis <= Z_AXIS; axis++)
+    expected[axis] = st_get_position(axis) + (base_home_pos(axis) + add_homeing[axis] - current_position[axis]) * axis_steps_per_unit[axis];
+
+  // The homing moves go from the raw stepper positions and the latched steps, which already hold the correction
+  // map and the plate tilt. The planner must not add them again until home is set.
+  float logical_position[NUM_AXIS];
+  memcpy(logical_position, current_position, sizeof(logical_position));
+  #ifdef XY_CORRECTION
+    bool xy_correction_was_active = xy_correction_active;
+    xy_correction_active = false;
+  #endif
+  #ifdef PLATE_TILT_COMPENSATION
+    bool plate_tilt_was_active = plate_tilt_active;
+    plate_tilt_active = false;
+  #endif
+
+  long trigger[3];
+  float distance[3];
+  for(int8_t axis=X_AXIS; axis <= Z_AXIS; axis++)
+    distance[axis] = 1.5 * max_length(axis);
+  uint8_t failed = homing_approach(mask, distance, homing_no_divisor, trigger);
+
+  // Back off from the latched steps, at the homing feedrate of the slowest axis
+  feedrate = 0;
+  for(int8_t axis=X_AXIS; axis <= Z_AXIS; axis++) {
+    if(!(mask & ~failed & (1<<axis))) continue;
+    destination[axis] = trigger[axis] / axis_steps_per_unit[axis] - homing_bump_mm[axis] * home_dir(axis);
+    if(feedrate == 0 || homing_feedrate[axis] < feedrate)
+      feedrate = homing_feedrate[axis];
+    distance[axis] = 2 * homing_bump_mm[axis];
+  }
+  #ifdef MUVE_Z_PEEL
+    destination[E_AXIS] += destination[Z_AXIS] - current_position[Z_AXIS];
+  #endif
+  if(feedrate > 0) {
+    plan_buffer_line(destination[X_AXIS], destination[Y_AXIS], destination[Z_AXIS], destination[E_AXIS], feedrate/60, active_extruder);
+    st_synchronize();
+    failed |= homing_approach(mask & ~failed, distance, homing_bump_divisor, trigger);
+  }
+
+  #ifdef XY_CORRECTION
+    xy_correction_active = xy_correction_was_active;
+  #endif
+  #ifdef PLATE_TILT_COMPENSATION
+    plate_tilt_active = plate_tilt_was_active;
+  #endif
+  for(int8_t axis=X_AXIS; axis <= Z_AXIS; axis++) {
+    if(!(mask & (1<<axis))) {
+      // Not homed, keep its position as it was, not the raw steps
+      current_position[axis] = logical_position[axis];
+      continue;
+    }
+    has_axis_homed[axis] = true;
+    axis_is_at_home(axis);
+    if(failed & (1<<axis)) {
+      // Where the move ended, as homing without TWO_PHASE_HOMING does
+      SERIAL_ERROR_START;
+      SERIAL_ERRORPGM("Homing: no endstop hit on ");
+      SERIAL_ERRORLN(axis_codes[axis]);
+      homing_error[axis] = 0;
+      continue;
+    }
+    homing_error[axis] = (trigger[axis] - expected[axis]) / axis_steps_per_unit[axis];
+    // The axis ran on after the latch
+    current_position[axis] += (st_get_position(axis) - trigger[axis]) / axis_steps_per_unit[axis];
+  }
+  #ifdef MUVE_Z_PEEL
+    plan_set_position(current_position[X_AXIS], current_position[Y_AXIS], current_position[Z_AXIS], current_position[Z_AXIS]);
+  #else
+    plan_set_position(current_position[X_AXIS], current_position[Y_AXIS], current_position[Z_AXIS], current_position[E_AXIS]);
+  #endif // MUVE_Z_PEEL
+  for(int8_t i=0; i < NUM_AXIS; i++)
+    destination[i] = current_position[i];
+  feedrate = 0.0;
+  endstops_hit_on_purpose();
+}
+#define HOMEAXIS(LETTER) home_axes(1<<LETTER##_AXIS)
+
+#endif // TWO_PHASE_HOMING
+
 void process_commands()
 {
   unsigned long codenum; //throw away variable
   char *starpos = NULL;
 
+  #ifdef SEGMENT_COALESCING
+  // Only G0 and G1 can join the move held back, everything else comes after it
+  if(!code_seen('G') || (int)code_value() > 1)
+    flush_coalesced_move();
+  #endif
+
   if(code_seen('G'))
   {
     switch((int)code_value())
@@ -923,7 +1361,7 @@ void process_commands()
       codenum += millis();  // keep track of when we started waiting
       previous_millis_cmd = millis();
       while(millis()  < codenum ){
-        #ifndef LASER
+        #if !defined(LASER) || defined(LASER_ONLY)
         manage_heater();
         #endif
         manage_inactivity();
@@ -931,6 +1369,21 @@ void process_commands()
       }
       break;
 
+    #ifdef BEZIER_CURVE_SUPPORT
+    case 5: // G5 - cubic Bezier
+      if(Stopped == false) {
+        get_coordinates();
+        float control[4] = {0.0, 0.0, 0.0, 0.0};
+        if(code_seen('I')) control[0] = code_value();
+        if(code_seen('J')) control[1] = code_value();
+        if(code_seen('P')) control[2] = code_value();
+        if(code_seen('Q')) control[3] = code_value();
+        prepare_bezier_move(control);
+        return;
+      }
+      break;
+    #endif
+
     #ifdef FWRETRACT
     case 10: // G10 retract
       if(!retracted)
@@ -1017,7 +1470,7 @@ void process_commands()
       }
       #endif
 
-      #ifdef QUICK_HOME
+      #if defined(QUICK_HOME) && !defined(TWO_PHASE_HOMING)
       if((home_all_axis)||( code_seen(axis_codes[X_AXIS]) && code_seen(axis_codes[Y_AXIS])) )  //first diagonal move
       {
         current_position[X_AXIS] = 0;current_position[Y_AXIS] = 0;
@@ -1057,6 +1510,11 @@ void process_commands()
       }
       #endif
 
+      #ifdef TWO_PHASE_HOMING
+      // X and Y home together
+      home_axes(((home_all_axis || code_seen(axis_codes[X_AXIS])) ? 1<<X_AXIS : 0) |
+                ((home_all_axis || code_seen(axis_codes[Y_AXIS])) ? 1<<Y_AXIS : 0));
+      #else
       if((home_all_axis) || (code_seen(axis_codes[X_AXIS])))
       {
       #ifdef DUAL_X_CARRIAGE
@@ -1079,6 +1537,7 @@ void process_commands()
       if((home_all_axis) || (code_seen(axis_codes[Y_AXIS]))) {
         HOMEAXIS(Y);
       }
+      #endif // TWO_PHASE_HOMING
 
       #if Z_HOME_DIR < 0                      // If homing towards BED do Z last
       if((home_all_axis) || (code_seen(axis_codes[Z_AXIS]))) {
@@ -1256,6 +1715,9 @@ void process_commands()
     case 24: //M24 - Start SD print
       card.startFileprint();
       starttime=millis();
+      #ifdef PRINT_PROGRESS
+      print_progress_start();
+      #endif
       break;
     case 25: //M25 - Pause SD print
       #ifdef LASER
@@ -1270,6 +1732,9 @@ void process_commands()
       break;
     case 27: //M27 - Get SD status
       card.getStatus();
+      #ifdef PRINT_PROGRESS
+      print_progress_report();
+      #endif
       break;
     case 28: //M28 - Start SD write
       starpos = (strchr(strchr_pointer + 4,'*'));
@@ -1308,6 +1773,9 @@ void process_commands()
       card.openFile(strchr_pointer + 4,true);
       card.startFileprint();
       starttime=millis();
+      #ifdef PRINT_PROGRESS
+      print_progress_start();
+      #endif
       break;
     case 928: //M928 - Start SD write
       starpos = (strchr(strchr_pointer + 5,'*'));
@@ -1363,6 +1831,7 @@ void process_commands()
         }
       }
      break;
+#ifndef LASER_ONLY
     case 104: // M104
       if(setTargetedHotend(104)){
         break;
@@ -1414,6 +1883,61 @@ void process_commands()
         SERIAL_PROTOCOLLN("");
       return;
       break;
+#else
+    case 105 : // M105 - laser diode and resin vat temperatures, reported as hotend and bed for the hosts
+      SERIAL_PROTOCOLPGM("ok T:");
+      SERIAL_PROTOCOL_F(degLaser(),1);
+      SERIAL_PROTOCOLPGM(" /0.0 B:");
+      SERIAL_PROTOCOL_F(degVat(),1);
+      #if HAS_VAT_HEATER
+        SERIAL_PROTOCOLPGM(" /");
+        SERIAL_PROTOCOL_F(degTargetVat(),1);
+        SERIAL_PROTOCOLPGM(" B@:");
+        SERIAL_PROTOCOL(getHeaterPower());
+        SERIAL_PROTOCOLLN("");
+      #else
+        SERIAL_PROTOCOLLNPGM(" /0.0");
+      #endif
+      return;
+      break;
+  #if HAS_VAT_HEATER
+    case 140: // M140 set vat temp
+      if (code_seen('S')) setTargetVat(code_value());
+      break;
+    case 190: // M190 - Wait for the vat to reach target.
+      LCD_MESSAGEPGM(MSG_BED_HEATING);
+      if (code_seen('S')) {
+        setTargetVat(code_value());
+        CooldownNoWait = true;
+      } else if (code_seen('R')) {
+        setTargetVat(code_value());
+        CooldownNoWait = false;
+      }
+      codenum = millis();
+
+      target_direction = isHeatingVat(); // true if heating, false if cooling
+
+      while ( target_direction ? (isHeatingVat()) : (isCoolingVat()&&(CooldownNoWait==false)) )
+      {
+        if(( millis() - codenum) > 1000 ) //Print Temp Reading every 1 second while heating up.
+        {
+          SERIAL_PROTOCOLPGM("T:");
+          SERIAL_PROTOCOL_F(degLaser(),1);
+          SERIAL_PROTOCOLPGM(" B:");
+          SERIAL_PROTOCOL_F(degVat(),1);
+          SERIAL_PROTOCOLLN("");
+          codenum = millis();
+        }
+        manage_heater();
+        manage_inactivity();
+        lcd_update();
+      }
+      LCD_MESSAGEPGM(MSG_BED_DONE);
+      previous_millis_cmd = millis();
+      break;
+  #endif //HAS_VAT_HEATER
+#endif //LASER_ONLY
+#ifndef LASER_ONLY
     case 109:
     {// M109 - Wait for extruder heater to reach target.
       if(setTargetedHotend(109)){
@@ -1541,6 +2065,7 @@ void process_commands()
         previous_millis_cmd = millis();
     #endif
         break;
+#endif //LASER_ONLY
 
     #if defined(FAN_PIN) && FAN_PIN > -1
       case 106: //M106 Fan On
@@ -1693,7 +2218,7 @@ void process_commands()
               float factor = axis_steps_per_unit[i] / value; // increase e constants if M92 E14 is given for netfab.
               max_e_jerk *= factor;
               max_feedrate[i] *= factor;
-              axis_steps_per_sqr_second[i] *= factor;
+              max_acceleration_units_per_sq_second[i] *= factor;
             }
             axis_steps_per_unit[i] = value;
           }
@@ -1702,6 +2227,7 @@ void process_commands()
           }
         }
       }
+      reset_acceleration_rates();
       break;
     case 115: // M115
       SERIAL_PROTOCOLPGM(MSG_M115_REPORT);
@@ -1787,14 +2313,16 @@ void process_commands()
       for(int8_t i=0; i < NUM_AXIS; i++) {
         if(code_seen(axis_codes[i])) max_feedrate[i] = code_value();
       }
+      reset_acceleration_rates();
       break;
     case 204: // M204 acclereration S normal moves T filmanent only moves
       {
         if(code_seen('S')) acceleration = code_value() ;
         if(code_seen('T')) retract_acceleration = code_value() ;
+        reset_acceleration_rates();
       }
       break;
-    case 205: //M205 advanced settings:  minimum travel speed S=while printing T=travel only,  B=minimum segment time X= maximum xy jerk, Z=maximum Z jerk
+    case 205: //M205 advanced settings:  minimum travel speed S=while printing T=travel only,  B=minimum segment time X= maximum xy jerk, Z=maximum Z jerk, J=junction deviation
     {
       if(code_seen('S')) minimumfeedrate = code_value();
       if(code_seen('T')) mintravelfeedrate = code_value();
@@ -1802,6 +2330,9 @@ void process_commands()
       if(code_seen('X')) max_xy_jerk = code_value() ;
       if(code_seen('Z')) max_z_jerk = code_value() ;
       if(code_seen('E')) max_e_jerk = code_value() ;
+      #ifdef JUNCTION_DEVIATION
+      if(code_seen('J')) junction_deviation = max(code_value(), 0.0) ;
+      #endif
     }
     break;
     case 206: // M206 additional homeing offset
@@ -2018,6 +2549,25 @@ void process_commands()
       }
       break;
     #endif //PIDTEMP
+    #ifdef PIDTEMPVAT
+    case 304: // M304 - vat PID
+      {
+        if(code_seen('P')) vatKp = code_value();
+        if(code_seen('I')) vatKi = scalePID_i(code_value());
+        if(code_seen('D')) vatKd = scalePID_d(code_value());
+
+        updatePID();
+        SERIAL_PROTOCOL(MSG_OK);
+        SERIAL_PROTOCOL(" p:");
+        SERIAL_PROTOCOL(vatKp);
+        SERIAL_PROTOCOL(" i:");
+        SERIAL_PROTOCOL(unscalePID_i(vatKi));
+        SERIAL_PROTOCOL(" d:");
+        SERIAL_PROTOCOL(unscalePID_d(vatKd));
+        SERIAL_PROTOCOLLN("");
+      }
+      break;
+    #endif //PIDTEMPVAT
     case 240: // M240  Triggers a camera by emulating a Canon RC-1 : http://www.doc-diy.net/photo/rc-1_hacked/
      {
       #if defined(PHOTOGRAPH_PIN) && PHOTOGRAPH_PIN > -1
@@ -2060,6 +2610,7 @@ void process_commands()
     }
     break;
   #endif
+    #ifndef LASER_ONLY
     case 303: // M303 PID autotune
     {
       float temp = 150.0;
@@ -2073,6 +2624,7 @@ void process_commands()
       PID_autotune(temp, e, c);
     }
     break;
+    #endif //LASER_ONLY
     case 400: // M400 finish all moves
     {
       st_synchronize();
@@ -2332,6 +2884,225 @@ void process_commands()
     break;
     #endif // MUVE_Z_PEEL
 
+    #ifdef VAT_EXPOSURE_COMPENSATION
+    case 652: // M652 S<mode> - vat temperature exposure compensation, 0 = off, 1 = intensity, 2 = feedrate
+    {
+      if(code_seen('S')) {
+        vat_exposure_mode = constrain((int)code_value(), VAT_EXPOSURE_OFF, VAT_EXPOSURE_FEEDRATE);
+        vat_exposure_update();
+      }
+      SERIAL_PROTOCOLPGM(MSG_OK);
+      SERIAL_PROTOCOLPGM(" mode:");
+      SERIAL_PROTOCOL((int)vat_exposure_mode);
+      SERIAL_PROTOCOLPGM(" vat:");
+      SERIAL_PROTOCOL_F(degVat(),1);
+      SERIAL_PROTOCOLPGM(" factor:");
+      SERIAL_PROTOCOL_F(vat_exposure_factor,3);
+      SERIAL_PROTOCOLLN("");
+    }
+    break;
+    #endif // VAT_EXPOSURE_COMPENSATION
+
+    #ifdef LASER_CALIBRATION
+    case 653: // M653 S<settle ms> - measure the laser output curve with the photodiode, M653 R resets it to a straight line
+    {
+      if(code_seen('R')) {
+        laser_calibration_reset();
+        SERIAL_ECHO_START;
+        SERIAL_ECHOLNPGM("Laser calibration reset");
+        break;
+      }
+      unsigned long settle = LASER_CALIBRATION_SETTLE;
+      if(code_seen('S')) settle = code_value_long();
+      st_synchronize();
+      LCD_MESSAGEPGM("Laser calibration");
+      if(laser_calibrate(settle)) {
+        SERIAL_ECHO_START;
+        SERIAL_ECHOLNPGM("Laser calibrated, M500 stores it");
+        LCD_MESSAGEPGM("Laser calibrated");
+      } else {
+        SERIAL_ERROR_START;
+        SERIAL_ERRORLNPGM("No laser output seen, calibration not changed");
+        LCD_MESSAGEPGM("Laser not seen");
+      }
+      previous_millis_cmd = millis();
+    }
+    break;
+    #endif // LASER_CALIBRATION
+
+    #ifdef LASER_LIFETIME
+    case 654: // M654 - report the laser on time, M654 S<seconds> sets it, M654 R resets it after a diode change
+    {
+      if(code_seen('R')) laser_lifetime_set(0);
+      else if(code_seen('S')) laser_lifetime_set(code_value_long());
+      laser_lifetime_update();
+      SERIAL_PROTOCOLPGM(MSG_OK);
+      SERIAL_PROTOCOLPGM(" laser on time:");
+      SERIAL_PROTOCOL(laser.lifetime / 3600);
+      SERIAL_PROTOCOLPGM("h ");
+      SERIAL_PROTOCOL((laser.lifetime / 60) % 60);
+      SERIAL_PROTOCOLPGM("m S");
+      SERIAL_PROTOCOL(laser.lifetime);
+      SERIAL_PROTOCOLLN("");
+    }
+    break;
+    #endif // LASER_LIFETIME
+
+    #ifdef XY_CORRECTION
+    case 655: // M655 I<column> J<row> X<error> Y<error> - set the XY position error (mm) measured at a point of the correction map, M655 R clears the map
+    {
+      if(code_seen('R')) {
+        memset(xy_correction, 0, sizeof(xy_correction));
+      }
+      else if(code_seen('I')) {
+        int i = code_value();
+        int j = code_seen('J') ? (int)code_value() : -1;
+        if(i < 0 || i >= XY_CORRECTION_POINTS_X || j < 0 || j >= XY_CORRECTION_POINTS_Y) {
+          SERIAL_ERROR_START;
+          SERIAL_ERRORLNPGM("M655 I and J have to be a point of the map");
+          break;
+        }
+        if(code_seen('X')) xy_correction[j][i][X_AXIS] = constrain(code_value() * 1000.0, -5000, 5000);
+        if(code_seen('Y')) xy_correction[j][i][Y_AXIS] = constrain(code_value() * 1000.0, -5000, 5000);
+      }
+      reset_xy_correction();
+      for(int j=0; j < XY_CORRECTION_POINTS_Y; j++) {
+        SERIAL_PROTOCOLPGM("J");
+        SERIAL_PROTOCOL(j);
+        SERIAL_PROTOCOLPGM(":");
+        for(int i=0; i < XY_CORRECTION_POINTS_X; i++) {
+          SERIAL_PROTOCOLPGM(" ");
+          SERIAL_PROTOCOL_F(xy_correction[j][i][X_AXIS] / 1000.0, 3);
+          SERIAL_PROTOCOLPGM(",");
+          SERIAL_PROTOCOL_F(xy_correction[j][i][Y_AXIS] / 1000.0, 3);
+        }
+        SERIAL_PROTOCOLLN("");
+      }
+    }
+    break;
+    #endif // XY_CORRECTION
+
+    #ifdef PLATE_TILT_COMPENSATION
+    case 656: // M656 P<point> X<pos> Y<pos> Z<error> - set the height error (mm) of the build plate measured at one of three points, M656 R clears the errors
+    {
+      if(code_seen('R')) {
+        for(int p=0; p < 3; p++) plate_tilt[p][Z_AXIS] = 0;
+      }
+      else if(code_seen('P')) {
+        int p = code_value();
+        if(p < 0 || p > 2) {
+          SERIAL_ERROR_START;
+          SERIAL_ERRORLNPGM("M656 P has to be 0, 1 or 2");
+          break;
+        }
+        if(code_seen('X')) plate_tilt[p][X_AXIS] = code_value();
+        if(code_seen('Y')) plate_tilt[p][Y_AXIS] = code_value();
+        if(code_seen('Z')) plate_tilt[p][Z_AXIS] = constrain(code_value(), -5, 5);
+      }
+      // Takes effect with the next move in Z, XY moves keep the Z motors where they are
+      reset_plate_tilt();
+      for(int p=0; p < 3; p++) {
+        SERIAL_PROTOCOLPGM("P");
+        SERIAL_PROTOCOL(p);
+        SERIAL_PROTOCOLPGM(" X:");
+        SERIAL_PROTOCOL_F(plate_tilt[p][X_AXIS], 2);
+        SERIAL_PROTOCOLPGM(" Y:");
+        SERIAL_PROTOCOL_F(plate_tilt[p][Y_AXIS], 2);
+        SERIAL_PROTOCOLPGM(" Z:");
+        SERIAL_PROTOCOL_F(plate_tilt[p][Z_AXIS], 3);
+        SERIAL_PROTOCOLLN("");
+      }
+      if(!plate_tilt_active && (plate_tilt[0][Z_AXIS] != 0 || plate_tilt[1][Z_AXIS] != 0 || plate_tilt[2][Z_AXIS] != 0)) {
+        SERIAL_ERROR_START;
+        SERIAL_ERRORLNPGM("M656 points are on a line, tilt compensation off");
+      }
+    }
+    break;
+    #endif // PLATE_TILT_COMPENSATION
+
+    #ifdef TWO_PHASE_HOMING
+    case 657: // M657 P<cycles> D<mm> X Y Z - home the axes over and over from D mm away, report how far each home is from the one before
+    {
+      int cycles = code_seen('P') ? code_value() : 10;
+      float distance = code_seen('D') ? code_value() : 10;
+      uint8_t mask = 0;
+      for(int8_t axis=X_AXIS; axis <= Z_AXIS; axis++)
+        if(code_seen(axis_codes[axis])) mask |= 1<<axis;
+      if(!mask) mask = (1<<X_AXIS) | (1<<Y_AXIS) | (1<<Z_AXIS);
+
+      float low[3] = { 0, 0, 0 }, high[3] = { 0, 0, 0 };
+      unsigned long longest = 0;
+      enable_endstops(true);
+      for(int c=-1; c < cycles; c++) {
+        if(c >= 0) {
+          for(int8_t axis=X_AXIS; axis <= Z_AXIS; axis++)
+            if(mask & (1<<axis)) destination[axis] = current_position[axis] - distance * home_dir(axis);
+          #ifdef MUVE_Z_PEEL
+            destination[E_AXIS] = destination[Z_AXIS];
+          #endif
+          feedrate = min(homing_feedrate[X_AXIS], min(homing_feedrate[Y_AXIS], homing_feedrate[Z_AXIS]));
+          plan_buffer_line(destination[X_AXIS], destination[Y_AXIS], destination[Z_AXIS], destination[E_AXIS], feedrate/60, active_extruder);
+          st_synchronize();
+          memcpy(current_position, destination, sizeof(current_position));
+        }
+        unsigned long start = millis();
+        #if Z_HOME_DIR > 0
+          home_axes(mask & (1<<Z_AXIS));
+        #endif
+        home_axes(mask & ((1<<X_AXIS) | (1<<Y_AXIS)));
+        #if Z_HOME_DIR < 0
+          home_axes(mask & (1<<Z_AXIS));
+        #endif
+        unsigned long elapsed = millis() - start;
+        manage_heater();
+        manage_inactivity();
+        lcd_update();
+        // The first home only sets where the others are measured from
+        if(c < 0) continue;
+        if(elapsed > longest) longest = elapsed;
+        SERIAL_PROTOCOLPGM("cycle ");
+        SERIAL_PROTOCOL(c);
+        SERIAL_PROTOCOLPGM(" ms:");
+        SERIAL_PROTOCOL(elapsed);
+        for(int8_t axis=X_AXIS; axis <= Z_AXIS; axis++) {
+          if(!(mask & (1<<axis))) continue;
+          low[axis] = (c == 0) ? homing_error[axis] : min(low[axis], homing_error[axis]);
+          high[axis] = (c == 0) ? homing_error[axis] : max(high[axis], homing_error[axis]);
+          SERIAL_PROTOCOLPGM(" ");
+          SERIAL_PROTOCOL(axis_codes[axis]);
+          SERIAL_PROTOCOLPGM(":");
+          SERIAL_PROTOCOL_F(homing_error[axis], 4);
+        }
+        SERIAL_PROTOCOLLN("");
+      }
+      SERIAL_PROTOCOLPGM("longest ms:");
+      SERIAL_PROTOCOL(longest);
+      SERIAL_PROTOCOLPGM(" range");
+      for(int8_t axis=X_AXIS; axis <= Z_AXIS; axis++) {
+        if(!(mask & (1<<axis))) continue;
+        SERIAL_PROTOCOLPGM(" ");
+        SERIAL_PROTOCOL(axis_codes[axis]);
+        SERIAL_PROTOCOLPGM(":");
+        SERIAL_PROTOCOL_F(high[axis] - low[axis], 4);
+      }
+      SERIAL_PROTOCOLLN("");
+      #ifdef ENDSTOPS_ONLY_FOR_HOMING
+        enable_endstops(false);
+      #endif
+    }
+    break;
+    #endif // TWO_PHASE_HOMING
+
+    #ifdef DOGLCD
+    case 658: // M658 - report the longest lcd_update() call (us) since the last M658, the longest the LCD held up the main loop
+    {
+      SERIAL_PROTOCOLPGM("lcd_update longest us:");
+      SERIAL_PROTOCOLLN(lcd_longest_update);
+      lcd_longest_update = 0;
+    }
+    break;
+    #endif // DOGLCD
+
     case 907: // M907 Set digital trimpot motor current using axis codes.
     {
       #if defined(DIGIPOTSS_PIN) && DIGIPOTSS_PIN > -1
@@ -2634,9 +3405,140 @@ void calculate_delta(float cartesian[3])
 }
 #endif
 
+#ifdef LASER_FIRE_E
+// Fire the laser for XY moves that move E, extinguish it when E stops or Z moves
+static void laser_fire_e()
+{
+  if (current_position[E_AXIS] != destination[E_AXIS] && 
+      ((current_position[X_AXIS] != destination[X_AXIS]) || 
+       (current_position[Y_AXIS] != destination[Y_AXIS])) &&
+      current_position[Z_AXIS] == destination[Z_AXIS]
+     ) {
+  laser.status = LASER_ON;
+  laser.fired = LASER_FIRE_E;
+  }
+  if ((current_position[E_AXIS] == destination[E_AXIS] || current_position[Z_AXIS] != destination[Z_AXIS]) && laser.fired == LASER_FIRE_E){
+    laser.status = LASER_OFF;
+  }
+}
+#endif // LASER_FIRE_E
+
+// Plans the line from..to. With MUVE_Z_PEEL the second Z motor takes the place of E in the planner. With
+// XY_CORRECTION the line is cut into pieces of at most XY_CORRECTION_SEGMENT mm, so it follows the map.
+static void plan_line(const float *from, const float *to, float feed_rate)
+{
+  #ifdef MUVE_Z_PEEL
+  const uint8_t e_axis = Z_AXIS;
+  #else
+  const uint8_t e_axis = E_AXIS;
+  #endif
+  #ifdef XY_CORRECTION
+  if (xy_correction_active) {
+    float dx = to[X_AXIS] - from[X_AXIS];
+    float dy = to[Y_AXIS] - from[Y_AXIS];
+    int segments = ceil(sqrt(sq(dx) + sq(dy)) / XY_CORRECTION_SEGMENT);
+    for (int s = 1; s < segments; s++) {
+      float fraction = float(s) / float(segments);
+      plan_buffer_line(from[X_AXIS] + dx * fraction, from[Y_AXIS] + dy * fraction,
+                       from[Z_AXIS] + (to[Z_AXIS] - from[Z_AXIS]) * fraction,
+                       from[e_axis] + (to[e_axis] - from[e_axis]) * fraction, feed_rate, active_extruder);
+    }
+  }
+  #endif
+  plan_buffer_line(to[X_AXIS], to[Y_AXIS], to[Z_AXIS], to[e_axis], feed_rate, active_extruder);
+}
+
+#ifdef SEGMENT_COALESCING
+// The XY move held back to join the next ones to, see coalesce_move()
+static bool coalesce_pending = false;
+static float coalesce_start[NUM_AXIS];
+static float coalesce_end[NUM_AXIS];
+static float coalesce_direction[2]; // Unit vector of the first move joined
+static float coalesce_feedrate;
+static float coalesce_e_per_mm;
+#ifdef LASER
+static bool coalesce_laser_status;
+static float coalesce_laser_intensity;
+static unsigned long coalesce_laser_duration;
+#endif
+
+void flush_coalesced_move()
+{
+  if (!coalesce_pending)
+    return;
+  coalesce_pending = false;
+  #ifdef LASER
+  // The planner takes the laser settings as they are now, give it the ones of the move held back
+  bool laser_status = laser.status;
+  float laser_intensity = laser.intensity;
+  unsigned long laser_duration = laser.duration;
+  laser.status = coalesce_laser_status;
+  laser.intensity = coalesce_laser_intensity;
+  laser.duration = coalesce_laser_duration;
+  #endif
+  plan_line(coalesce_start, coalesce_end, coalesce_feedrate*feedmultiply/60/100.0);
+  #ifdef LASER
+  laser.status = laser_status;
+  laser.intensity = laser_intensity;
+  laser.duration = laser_duration;
+  #endif
+}
+
+void discard_coalesced_move()
+{
+  coalesce_pending = false;
+}
+
+// Joins the XY move from current_position to destination to the one held back when it goes on in the
+// same direction with the same settings. The end point has to stay within half the tolerance of the line
+// the first move started, then every joint stays within the tolerance of the joined move.
+static void coalesce_move()
+{
+  float dx = destination[X_AXIS] - current_position[X_AXIS];
+  float dy = destination[Y_AXIS] - current_position[Y_AXIS];
+  float length = sqrt(dx*dx + dy*dy);
+  float e_per_mm = (destination[E_AXIS] - current_position[E_AXIS]) / length;
+
+  if (coalesce_pending && feedrate == coalesce_feedrate &&
+      fabs(e_per_mm - coalesce_e_per_mm) <= 0.01 * fabs(coalesce_e_per_mm)
+      #ifdef LASER
+      && laser.status == coalesce_laser_status && laser.intensity == coalesce_laser_intensity
+      && laser.duration == coalesce_laser_duration
+      #endif
+     ) {
+    float ex = destination[X_AXIS] - coalesce_start[X_AXIS];
+    float ey = destination[Y_AXIS] - coalesce_start[Y_AXIS];
+    float along = ex*coalesce_direction[0] + ey*coalesce_direction[1];
+    float across = ex*coalesce_direction[1] - ey*coalesce_direction[0];
+    if (dx*coalesce_direction[0] + dy*coalesce_direction[1] > 0 && along <= SEGMENT_COALESCING_MAX_LENGTH &&
+        fabs(across) <= SEGMENT_COALESCING_TOLERANCE / 2) {
+      memcpy(coalesce_end, destination, sizeof(coalesce_end));
+      return;
+    }
+  }
+
+  flush_coalesced_move();
+  memcpy(coalesce_start, current_position, sizeof(coalesce_start));
+  memcpy(coalesce_end, destination, sizeof(coalesce_end));
+  coalesce_direction[0] = dx / length;
+  coalesce_direction[1] = dy / length;
+  coalesce_feedrate = feedrate;
+  coalesce_e_per_mm = e_per_mm;
+  #ifdef LASER
+  coalesce_laser_status = laser.status;
+  coalesce_laser_intensity = laser.intensity;
+  coalesce_laser_duration = laser.duration;
+  #endif
+  coalesce_pending = true;
+}
+#endif // SEGMENT_COALESCING
+
 void prepare_move()
 {
   clamp_to_software_endstops(destination);
+  #ifdef PRINT_PROGRESS
+  print_progress_layer();
+  #endif
 
   previous_millis_cmd = millis();
 #ifdef DELTA
@@ -2708,21 +3610,14 @@ void prepare_move()
 #endif //DUAL_X_CARRIAGE
 
   #ifdef LASER_FIRE_E
-  if (current_position[E_AXIS] != destination[E_AXIS] && 
-      ((current_position[X_AXIS] != destination[X_AXIS]) || 
-       (current_position[Y_AXIS] != destination[Y_AXIS])) &&
-      current_position[Z_AXIS] == destination[Z_AXIS]
-     ) {
-  laser.status = LASER_ON;
-  laser.fired = LASER_FIRE_E;
-  }
-  if ((current_position[E_AXIS] == destination[E_AXIS] || current_position[Z_AXIS] != destination[Z_AXIS]) && laser.fired == LASER_FIRE_E){
-    laser.status = LASER_OFF;
-  }
+  laser_fire_e();
   #endif // LASER_FIRE_E
 
   // Do not use feedmultiply for E or Z only moves
   if((current_position[X_AXIS] == destination [X_AXIS]) && (current_position[Y_AXIS] == destination [Y_AXIS])) {
+      #ifdef SEGMENT_COALESCING
+        flush_coalesced_move();
+      #endif
       #ifdef MUVE_Z_PEEL
         plan_buffer_line(destination[X_AXIS], destination[Y_AXIS], destination[Z_AXIS], destination[Z_AXIS], feedrate/60, active_extruder);
         current_position[E_AXIS] = current_position[Z_AXIS];
@@ -2730,12 +3625,16 @@ void prepare_move()
         plan_buffer_line(destination[X_AXIS], destination[Y_AXIS], destination[Z_AXIS], destination[E_AXIS], feedrate/60, active_extruder);
       #endif // MUVE_Z_PEEL
   }
+  #ifdef SEGMENT_COALESCING
+  else if (current_position[Z_AXIS] == destination[Z_AXIS]) {
+    coalesce_move();
+  }
+  #endif
   else {
-  #ifdef MUVE_Z_PEEL
-    plan_buffer_line(destination[X_AXIS], destination[Y_AXIS], destination[Z_AXIS], destination[Z_AXIS], feedrate*feedmultiply/60/100.0, active_extruder);
-  #else
-      plan_buffer_line(destination[X_AXIS], destination[Y_AXIS], destination[Z_AXIS], destination[E_AXIS], feedrate*feedmultiply/60/100.0, active_extruder);
-  #endif // MUVE_Z_PEEL
+  #ifdef SEGMENT_COALESCING
+    flush_coalesced_move();
+  #endif
+    plan_line(current_position, destination, feedrate*feedmultiply/60/100.0);
   }
 #endif //else DELTA
   for(int8_t i=0; i < NUM_AXIS; i++) {
@@ -2743,11 +3642,28 @@ void prepare_move()
   }
 }
 
+// Curves run from current_position to destination. Like in prepare_move() the laser follows E, and with
+// MUVE_Z_PEEL the second Z motor takes the place of E in the planner.
+static void prepare_curve(float *start, float *end)
+{
+  #ifdef LASER_FIRE_E
+  laser_fire_e();
+  #endif
+  memcpy(start, current_position, sizeof(current_position));
+  memcpy(end, destination, sizeof(destination));
+  #ifdef MUVE_Z_PEEL
+  start[E_AXIS] = start[Z_AXIS];
+  end[E_AXIS] = end[Z_AXIS];
+  #endif
+}
+
 void prepare_arc_move(char isclockwise) {
   float r = hypot(offset[X_AXIS], offset[Y_AXIS]); // Compute arc radius for mc_arc
 
   // Trace the arc
-  mc_arc(current_position, destination, offset, X_AXIS, Y_AXIS, Z_AXIS, feedrate*feedmultiply/60/100.0, r, isclockwise, active_extruder);
+  float start[NUM_AXIS], end[NUM_AXIS];
+  prepare_curve(start, end);
+  mc_arc(start, end, offset, X_AXIS, Y_AXIS, Z_AXIS, feedrate*feedmultiply/60/100.0, r, isclockwise, active_extruder);
 
   // As far as the parser is concerned, the position is now == target. In reality the
   // motion control system might still be processing the action and the real tool position
@@ -2758,6 +3674,21 @@ void prepare_arc_move(char isclockwise) {
   previous_millis_cmd = millis();
 }
 
+#ifdef BEZIER_CURVE_SUPPORT
+void prepare_bezier_move(float *control) {
+  clamp_to_software_endstops(destination);
+
+  float start[NUM_AXIS], end[NUM_AXIS];
+  prepare_curve(start, end);
+  mc_bezier(start, end, control, feedrate*feedmultiply/60/100.0, active_extruder);
+
+  for(int8_t i=0; i < NUM_AXIS; i++) {
+    current_position[i] = destination[i];
+  }
+  previous_millis_cmd = millis();
+}
+#endif // BEZIER_CURVE_SUPPORT
+
 #if defined(CONTROLLERFAN_PIN) && CONTROLLERFAN_PIN > -1
 
 #if defined(FAN_PIN)
@@ -2864,6 +3795,12 @@ void manage_inactivity()
       prepare_move();
     }
   #endif
+  #ifdef LASER_LIFETIME
+    laser_lifetime_update();
+  #endif
+  #if defined(EEPROM_SETTINGS) && defined(EEPROM_BACKGROUND_WRITES)
+    Config_ReportStored();
+  #endif
 
   check_axes_activity();
 }
@@ -2872,6 +3809,9 @@ void kill()
 {
   cli(); // Stop interrupts
   disable_heater();
+#ifdef SEGMENT_COALESCING
+  discard_coalesced_move();
+#endif
 
   disable_x();
   disable_y();
@@ -2899,6 +3839,9 @@ void Stop()
 #ifdef LASER
   laser_extinguish();
 #endif
+#ifdef SEGMENT_COALESCING
+  discard_coalesced_move(); // loop() would still plan it
+#endif
 #ifdef LASER_PERIPHERALS
   laser_peripherals_off();
 #endif
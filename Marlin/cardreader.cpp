@@ -17,6 +17,9 @@ CardReader::CardReader()
    sdpos = 0;
    sdprinting = false;
    cardOK = false;
+   #ifdef SD_BINARY_JOBS
+   binaryjob = false;
+   #endif
    saving = false;
    logging = false;
    autostart_atmillis=0;
@@ -292,6 +295,20 @@ void CardReader::openFile(char* name,bool read)
       SERIAL_PROTOCOLPGM(MSG_SD_SIZE);
       SERIAL_PROTOCOLLN(filesize);
       sdpos = 0;
+      #ifdef SD_BINARY_JOBS
+      binaryjob = false;
+      bj_header_t header;
+      if(file.read(&header, sizeof(header)) == sizeof(header) && strncmp(header.magic, BJ_MAGIC, 4) == 0 && header.version >= 1 && header.version <= BJ_VERSION && header.units_per_mm > 0)
+      {
+        binaryjob = true;
+        binary_units_per_mm = header.units_per_mm;
+        sdpos = sizeof(header);
+        SERIAL_PROTOCOLPGM("Binary job, records: ");
+        SERIAL_PROTOCOLLN(header.records);
+      }
+      else
+        setIndex(0);
+      #endif
       
       SERIAL_PROTOCOLLNPGM(MSG_SD_FILE_SELECTED);
       lcd_setstatus(fname);
@@ -561,4 +578,4 @@ void CardReader::printingHasFinished()
     autotempShutdown();
     #endif
 }
-#endif //SDSUPPORT
+#endif //SDSUPPORT
@@ -7,6 +7,35 @@
 
 #include "SdFile.h"
 enum LsAction {LS_SerialPrint,LS_Count,LS_GetFilename};
+
+#ifdef SD_BINARY_JOBS
+// Binary layer job layout, see create_binary_job.py for the host side.
+// All fields are little endian, the same as the AVR, so they are read straight into memory.
+#define BJ_MAGIC "MUVB"
+#define BJ_VERSION 2 // version 1 files, without the E records, are still read
+typedef struct {
+  char magic[4];          // BJ_MAGIC, without the terminating zero
+  uint8_t version;        // BJ_VERSION
+  uint8_t flags;          // reserved, 0
+  uint16_t units_per_mm;  // fixed point scale of all coordinates
+  uint32_t records;       // number of records following the header
+  uint32_t reserved;
+} bj_header_t;
+
+// Record opcodes, each followed by its payload
+#define BJ_MOVE_REL   0x01 // int16 dx, int16 dy : XY move relative to the last endpoint
+#define BJ_MOVE_ABS   0x02 // int32 x, int32 y   : XY move to an absolute endpoint
+#define BJ_FEEDRATE   0x03 // uint16 mm/min
+#define BJ_MOVE_Z     0x04 // int32 z            : Z only move to an absolute height
+#define BJ_MOVE_REL_E 0x05 // int16 dx, int16 dy, int16 de : BJ_MOVE_REL that also moves E by de
+#define BJ_MOVE_ABS_E 0x06 // int32 x, int32 y, int32 de   : BJ_MOVE_ABS that also moves E by de
+#define BJ_MOVE_E     0x07 // int32 de           : E only move
+#define BJ_LASER_ON   0x10 // uint16 intensity in 1/100 %
+#define BJ_LASER_OFF  0x11 // no payload
+#define BJ_LAYER      0x20 // uint16 layer number : marks the start of a new layer
+#define BJ_GCODE      0x7F // uint8 length, length characters : executed as a normal command
+#endif //SD_BINARY_JOBS
+
 class CardReader
 {
 public:
@@ -42,6 +71,11 @@ public:
   FORCE_INLINE bool eof() { return sdpos>=filesize ;};
   FORCE_INLINE int16_t get() {  sdpos = file.curPosition();return (int16_t)file.read();};
   FORCE_INLINE void setIndex(long index) {sdpos = index;file.seekSet(index);};
+  #ifdef SD_BINARY_JOBS
+  FORCE_INLINE bool read(void* buf, uint16_t nbyte) { int16_t n = file.read(buf, nbyte); sdpos = file.curPosition(); return n == (int16_t)nbyte; };
+  #endif
+  FORCE_INLINE uint32_t getIndex() { return sdpos; };
+  FORCE_INLINE uint32_t getFileSize() { return filesize; };
   FORCE_INLINE uint8_t percentDone(){if(!isFileOpen()) return 0; if(filesize) return sdpos/((filesize+99)/100); else return 0;};
   FORCE_INLINE char* getWorkDirName(){workDir.getFilename(filename);return filename;};
 
@@ -54,6 +88,10 @@ public:
   char longFilename[LONG_FILENAME_LENGTH];
   bool filenameIsDir;
   int lastnr; //last number of the autostart;
+  #ifdef SD_BINARY_JOBS
+  bool binaryjob; //the open file is a binary layer job, not G-code
+  uint16_t binary_units_per_mm;
+  #endif
 private:
   SdFile root,*curDir,workDir,workDirParents[MAX_DIR_DEPTH];
   uint16_t workDirDepth;
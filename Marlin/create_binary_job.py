@@ -0,0 +1,252 @@
+#!/usr/bin/env python
+
+""" Convert sliced G-code into a binary layer job for SD printing (see SD_BINARY_JOBS).
+
+The firmware feeds the records of a binary job straight into the planner instead of
+parsing G-code line by line. XY endpoints are stored as fixed point integers, short
+moves as 16 bit deltas. E travel goes with the XY moves as a delta, so LASER_FIRE_E
+fires the same as from the G-code. Laser on/off (M3/M5), feedrate, Z moves and layer
+markers have their own records, every other command is embedded as a G-code line and
+executed as usual. Moves the converter can't place, e.g. relative ones after a G28
+homed an axis to an unknown spot, are embedded too.
+
+Name the output *.G?? (e.g. LAYER.GCB), the LCD file browser only lists G files.
+"""
+
+from __future__ import print_function
+
+import argparse
+import re
+import struct
+import sys
+
+__license__ = "GPL"
+
+# Keep in sync with cardreader.h
+BJ_MAGIC = b"MUVB"
+BJ_VERSION = 2
+BJ_MOVE_REL = 0x01
+BJ_MOVE_ABS = 0x02
+BJ_FEEDRATE = 0x03
+BJ_MOVE_Z = 0x04
+BJ_MOVE_REL_E = 0x05
+BJ_MOVE_ABS_E = 0x06
+BJ_MOVE_E = 0x07
+BJ_LASER_ON = 0x10
+BJ_LASER_OFF = 0x11
+BJ_LAYER = 0x20
+BJ_GCODE = 0x7F
+
+MAX_CMD_SIZE = 96  # Configuration_adv.h
+
+WORD = re.compile(r"([A-Z])\s*([-+]?[0-9]*\.?[0-9]*)")
+LAYER_COMMENT = re.compile(r";\s*LAYER\s*:?\s*(\d+)", re.IGNORECASE)
+
+
+class Converter(object):
+    def __init__(self, units_per_mm):
+        self.units = units_per_mm
+        self.out = bytearray()
+        self.records = 0
+        self.moves = 0
+        self.relative = False          # G91
+        self.e_relative = False        # M83
+        self.pos = [None, None, None]  # converter's idea of the position, in file units
+        self.mm = [0.0, 0.0, 0.0]      # same in mm, for relative G-code, None where unknown
+        self.e = 0.0                   # E position in mm
+        self.feedrate = None
+        self.laser = None              # None (unknown), or intensity in 1/100 %
+        self.layer = 0
+
+    def record(self, op, fmt="", *values):
+        self.out += struct.pack("<B" + fmt, op, *values)
+        self.records += 1
+
+    def fixed(self, mm):
+        return int(round(mm * self.units))
+
+    def forget_position(self):
+        self.pos = [None, None, None]
+
+    def gcode(self, line):
+        data = line.encode("ascii")
+        if len(data) >= MAX_CMD_SIZE:
+            raise ValueError("command too long for the firmware buffer: " + line)
+        self.record(BJ_GCODE, "B%ds" % len(data), len(data), data)
+
+    def set_feedrate(self, words):
+        if "F" in words and words["F"] > 0:
+            f = int(round(words["F"]))
+            if f != self.feedrate:
+                self.record(BJ_FEEDRATE, "H", min(f, 0xFFFF))
+                self.feedrate = f
+
+    def laser_on(self, intensity):
+        value = max(0, min(10000, int(round(intensity * 100))))
+        if value != self.laser:
+            self.record(BJ_LASER_ON, "H", value)
+            self.laser = value
+
+    def laser_off(self):
+        if self.laser != 0:
+            self.record(BJ_LASER_OFF)
+            self.laser = 0
+
+    def target(self, words):
+        target = list(self.mm)
+        for i, axis in enumerate("XYZ"):
+            if axis in words:
+                if not self.relative:
+                    target[i] = words[axis]
+                elif target[i] is not None:
+                    target[i] += words[axis]
+        return target
+
+    def e_target(self, words):
+        if "E" not in words:
+            return self.e
+        return words["E"] + (self.e if self.relative or self.e_relative else 0.0)
+
+    def embedded_move(self, line, words):
+        # the firmware parses it, in the G90/G91 and M82/M83 modes it was given
+        self.gcode(line)
+        self.forget_position()
+        self.mm = self.target(words)
+        self.e = self.e_target(words)
+
+    def move(self, line, words):
+        target = self.target(words)
+        e = self.e_target(words)
+        de = self.fixed(e) - self.fixed(self.e)
+        xy_moves = "X" in words or "Y" in words
+        z_moves = "Z" in words and (target[2] is None or self.fixed(target[2]) != self.pos[2])
+        if (xy_moves and z_moves) or (z_moves and de) or None in (target[2:] if z_moves else target[:2] if xy_moves else []):
+            # not worth a record type on a layer printer, or we don't know where it goes
+            self.embedded_move(line, words)
+            return
+        fixed = [self.fixed(v) if v is not None else None for v in target]
+        self.set_feedrate(words)
+        if z_moves:
+            self.record(BJ_MOVE_Z, "i", fixed[2])
+        elif xy_moves:
+            dx = dy = None
+            if None not in self.pos[:2]:
+                dx = fixed[0] - self.pos[0]
+                dy = fixed[1] - self.pos[1]
+            if dx is not None and -0x8000 <= dx < 0x8000 and -0x8000 <= dy < 0x8000 and -0x8000 <= de < 0x8000:
+                if de:
+                    self.record(BJ_MOVE_REL_E, "hhh", dx, dy, de)
+                else:
+                    self.record(BJ_MOVE_REL, "hh", dx, dy)
+            elif de:
+                self.record(BJ_MOVE_ABS_E, "iii", fixed[0], fixed[1], de)
+            else:
+                self.record(BJ_MOVE_ABS, "ii", fixed[0], fixed[1])
+        elif de:
+            self.record(BJ_MOVE_E, "i", de)
+        else:
+            return
+        self.moves += 1
+        if z_moves:
+            self.pos[2] = fixed[2]
+        elif xy_moves:
+            self.pos[0], self.pos[1] = fixed[0], fixed[1]
+        self.mm = target
+        self.e = e
+
+    def line(self, raw):
+        m = LAYER_COMMENT.search(raw)
+        if m:
+            self.layer = int(m.group(1))
+            self.record(BJ_LAYER, "H", self.layer & 0xFFFF)
+        line = raw.split(";", 1)[0].strip().upper()
+        if not line:
+            return
+        words = {}
+        for letter, value in WORD.findall(line):
+            try:
+                words.setdefault(letter, float(value) if value else 0.0)
+            except ValueError:
+                pass
+        if "G" in words:
+            g = int(words["G"])
+            if g in (0, 1):
+                self.move(line, words)
+                return
+            if g in (2, 3):
+                self.embedded_move(line, words)
+                return
+            # G28, G92, G90, G91, ...: the firmware handles them
+            self.gcode(line)
+            if g == 90:
+                self.relative = False
+            elif g == 91:
+                self.relative = True
+            elif g == 92:
+                self.forget_position()
+                for i, axis in enumerate("XYZ"):
+                    if axis in words:
+                        self.mm[i] = words[axis]
+                if "E" in words:
+                    self.e = words["E"]
+            elif g == 28:
+                # homed to where the endstops are, unknown until an absolute move or G92
+                self.forget_position()
+                homed = [axis in words for axis in "XYZ"]
+                for i in range(3):
+                    if homed[i] or not any(homed):
+                        self.mm[i] = None
+            return
+        if "M" in words:
+            m = int(words["M"])
+            if m in (82, 83):
+                self.e_relative = m == 83
+            if m == 3:
+                self.laser_on(words.get("S", 100.0))
+                return
+            if m == 5:
+                self.laser_off()
+                return
+            if m in (6, 7, 8, 650, 651):
+                self.forget_position()
+        self.gcode(line)
+
+    def header(self):
+        return struct.pack("<4sBBHII", BJ_MAGIC, BJ_VERSION, 0, self.units, self.records, 0)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('input', help='sliced G-code file')
+    parser.add_argument('output', help='binary job to write, e.g. LAYER.GCB')
+    parser.add_argument('-u', '--units-per-mm', type=int, default=1000, help='fixed point scale (default=1000, 1 micron)')
+    args = parser.parse_args()
+
+    if not 0 < args.units_per_mm <= 0xFFFF:
+        parser.error("units per mm must fit in 16 bits")
+
+    conv = Converter(args.units_per_mm)
+    ascii_size = 0
+    ascii_lines = 0
+    with open(args.input) as f:
+        for raw in f:
+            ascii_size += len(raw)
+            if raw.split(";", 1)[0].strip():
+                ascii_lines += 1
+            conv.line(raw.rstrip("\r\n"))
+
+    with open(args.output, "wb") as f:
+        f.write(conv.header())
+        f.write(conv.out)
+
+    binary_size = 16 + len(conv.out)
+    print("G-code: %d bytes, %d commands" % (ascii_size, ascii_lines), file=sys.stderr)
+    print("binary: %d bytes, %d records, %d moves (%.1f%% of the G-code size)" %
+          (binary_size, conv.records, conv.moves, 100.0 * binary_size / max(ascii_size, 1)), file=sys.stderr)
+    if conv.records:
+        print("average per command: %.1f bytes G-code, %.1f bytes binary" %
+              (float(ascii_size) / max(ascii_lines, 1), float(len(conv.out)) / conv.records), file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()
@@ -149,6 +149,9 @@ static void lcd_implementation_init()
 
 static void lcd_implementation_clear()
 {
+#if defined(U8GLIB_ST7920) && (defined(LCD_INCREMENTAL_UPDATE) || defined(ST7920_HARDWARE_SPI))
+	u8g_dev_rrd_st7920_resend(); // the next frame goes out whole
+#endif
 // NO NEED TO IMPLEMENT LIKE SO. Picture loop automatically clears the display.
 //
 // Check this article: http://arduino.cc/forum/index.php?topic=91395.25;wap2
@@ -225,6 +228,14 @@ static void lcd_implementation_status_screen()
  if(starttime != 0)
     {
         uint16_t time = millis()/60000 - starttime/60000;
+#ifdef PRINT_PROGRESS
+		char label = print_progress_clock(time);
+		if (label) {
+			u8g.setPrintPos(73,47);
+			u8g.print(label);
+			u8g.setPrintPos(80,47);
+		}
+#endif
 
 		u8g.print(itostr2(time/60));
 		u8g.print(':');
@@ -307,6 +318,24 @@ static void lcd_implementation_status_screen()
 		 u8g.drawBox(88,18,2,2);
 		 u8g.setColorIndex(1);	// black on white
 		}
+#endif
+#ifdef LASER_ONLY
+ // Laser diode and resin vat temperatures
+ u8g.setFont(FONT_STATUSMENU);
+ #if HAS_LASER_TEMP
+ u8g.setPrintPos(55,6);
+ lcd_printPGM(PSTR("LD"));
+ u8g.setPrintPos(55,27);
+ u8g.print(itostr3(int(degLaser() + 0.5)));
+ lcd_printPGM(PSTR(LCD_STR_DEGREE " "));
+ #endif
+ #if HAS_VAT_TEMP
+ u8g.setPrintPos(81,6);
+ lcd_printPGM(PSTR("VAT"));
+ u8g.setPrintPos(81,27);
+ u8g.print(itostr3(int(degVat() + 0.5)));
+ lcd_printPGM(PSTR(LCD_STR_DEGREE " "));
+ #endif
 #endif
  // Fan
  u8g.setFont(FONT_STATUSMENU);
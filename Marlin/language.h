@@ -70,6 +70,7 @@
 	#define MSG_NOZZLE1 "Nozzle2"
 	#define MSG_NOZZLE2 "Nozzle3"
 	#define MSG_BED "Bed"
+	#define MSG_VAT "Vat"
 	#define MSG_FAN_SPEED "Fan speed"
 	#define MSG_FLOW "Flow"
 	#define MSG_CONTROL "Control"
@@ -85,6 +86,7 @@
 	#define MSG_PID_C "PID-C"
 	#define MSG_ACC  "Accel"
 	#define MSG_VXY_JERK "Vxy-jerk"
+	#define MSG_JUNCTION_DEVIATION "J-dev"
 	#define MSG_VZ_JERK "Vz-jerk"
 	#define MSG_VE_JERK "Ve-jerk"
 	#define MSG_VMAX "Vmax "
@@ -232,6 +234,7 @@
 	#define MSG_NOZZLE1 "Dysza2"
 	#define MSG_NOZZLE2 "Dysza3"
 	#define MSG_BED "Loze"
+	#define MSG_VAT "Kadz"
 	#define MSG_FAN_SPEED "Obroty wiatraka"
 	#define MSG_FLOW "Przeplyw"
 	#define MSG_CONTROL "Kontrola"
@@ -247,6 +250,7 @@
 	#define MSG_PID_C "PID-C"
 	#define MSG_ACC  "Acc"
 	#define MSG_VXY_JERK "Zryw Vxy"
+	#define MSG_JUNCTION_DEVIATION "J-dev"
 	#define MSG_VZ_JERK "Zryw Vz"
 	#define MSG_VE_JERK "Zryw Ve"
 	#define MSG_VMAX "Vmax"
@@ -398,6 +402,7 @@
 	#define MSG_NOZZLE1 "Buse2"
 	#define MSG_NOZZLE2 "Buse3"
 	#define MSG_BED "Plateau"
+	#define MSG_VAT "Bac"
 	#define MSG_FAN_SPEED "Vitesse ventilateur"
 	#define MSG_FLOW "Flux"
 	#define MSG_CONTROL "Controler"
@@ -413,6 +418,7 @@
 	#define MSG_PID_C "PID-C"
 	#define MSG_ACC "Accel"
 	#define MSG_VXY_JERK "Vxy-jerk"
+	#define MSG_JUNCTION_DEVIATION "J-dev"
 	#define MSG_VZ_JERK "Vz-jerk"
 	#define MSG_VE_JERK "Ve-jerk"
 	#define MSG_VMAX "Vmax"
@@ -563,6 +569,7 @@
 	#define MSG_NOZZLE1          "Düse2"
 	#define MSG_NOZZLE2          "Düse3"
 	#define MSG_BED              "Bett"
+	#define MSG_VAT              "Wanne"
 	#define MSG_FAN_SPEED        "Lüftergeschw."
 	#define MSG_FLOW             "Fluss"
 	#define MSG_CONTROL          "Einstellungen"
@@ -578,6 +585,7 @@
 	#define MSG_PID_C            "PID-C"
 	#define MSG_ACC              "Acc"
 	#define MSG_VXY_JERK         "Vxy-jerk"
+	#define MSG_JUNCTION_DEVIATION "J-dev"
 	#define MSG_VZ_JERK          "Vz-jerk"
 	#define MSG_VE_JERK          "Ve-jerk"
 	#define MSG_VMAX             "Vmax "
@@ -728,6 +736,7 @@
 	#define MSG_NOZZLE1 "Nozzle2"
 	#define MSG_NOZZLE2 "Nozzle3"
 	#define MSG_BED "Base"
+	#define MSG_VAT "Cuba"
 	#define MSG_FAN_SPEED "Ventilador"
 	#define MSG_FLOW "Flujo"
 	#define MSG_CONTROL "Control"
@@ -743,6 +752,7 @@
 	#define MSG_PID_C "PID-C"
 	#define MSG_ACC  "Acel"
 	#define MSG_VXY_JERK "Vxy-jerk"
+	#define MSG_JUNCTION_DEVIATION "J-dev"
 	#define MSG_VZ_JERK "Vz-jerk"
 	#define MSG_VE_JERK "Ve-jerk"
 	#define MSG_VMAX "Vmax"
@@ -897,6 +907,7 @@
 	#define MSG_NOZZLE1							" \002 Фильера2:"
 	#define MSG_NOZZLE2							" \002 Фильера3:"
 	#define MSG_BED								" \002 Кровать:"
+	#define MSG_VAT								" \002 Ванна:"
 	#define MSG_FAN_SPEED						" Куллер:"
 	#define MSG_FLOW							" Поток:"
 	#define MSG_CONTROL							" Настройки \003"
@@ -912,6 +923,7 @@
 	#define MSG_PID_C							" PID-C: "
 	#define MSG_ACC								" Acc:"
 	#define MSG_VXY_JERK						" Vxy-jerk: "
+	#define MSG_JUNCTION_DEVIATION				" J-dev: "
 	#define MSG_VZ_JERK                         "Vz-jerk"
 	#define MSG_VE_JERK                         "Ve-jerk"
 	#define MSG_VMAX							" Vmax "
@@ -1058,6 +1070,7 @@
 	#define MSG_NOZZLE1              "Ugello2"
 	#define MSG_NOZZLE2              "Ugello3"
 	#define MSG_BED                  "Piatto"
+	#define MSG_VAT                  "Vasca"
 	#define MSG_FAN_SPEED            "Ventola"
 	#define MSG_FLOW                 "Flusso"
 	#define MSG_CONTROL              "Controllo"
@@ -1073,6 +1086,7 @@
 	#define MSG_PID_C                "PID-C"
 	#define MSG_ACC                  "Accel"
 	#define MSG_VXY_JERK             "Vxy-jerk"
+	#define MSG_JUNCTION_DEVIATION   "J-dev"
 	#define MSG_VZ_JERK              "Vz-jerk"
 	#define MSG_VE_JERK              "Ve-jerk"
 	#define MSG_VMAX                 "Vmax"
@@ -1223,6 +1237,7 @@
 	#define MSG_NOZZLE1 " \002Nozzle2:"
 	#define MSG_NOZZLE2 " \002Nozzle3:"
 	#define MSG_BED " \002Base:"
+	#define MSG_VAT " \002Cuba:"
 	#define MSG_FAN_SPEED " Velocidade Ventoinha:"
 	#define MSG_FLOW " Fluxo:"
 	#define MSG_CONTROL " Controle \003"
@@ -1238,6 +1253,7 @@
 	#define MSG_PID_C " PID-C: "
 	#define MSG_ACC  " Acc:"
 	#define MSG_VXY_JERK " Vxy-jerk: "
+	#define MSG_JUNCTION_DEVIATION " J-dev: "
 	#define MSG_VZ_JERK "Vz-jerk"
 	#define MSG_VE_JERK "Ve-jerk"
 	#define MSG_VMAX " Vmax "
@@ -1395,6 +1411,7 @@
 	#define MSG_NOZZLE1 "Suutin2"
 	#define MSG_NOZZLE2 "Suutin3"
 	#define MSG_BED "Alusta"
+	#define MSG_VAT "Allas"
 	#define MSG_FAN_SPEED "Tuul. nopeus"
 	#define MSG_FLOW "Virtaus"
 	#define MSG_CONTROL "Kontrolli"
@@ -1410,6 +1427,7 @@
 	#define MSG_PID_C "PID-C"
 	#define MSG_ACC  "Kiihtyv"
 	#define MSG_VXY_JERK "Vxy-jerk"
+	#define MSG_JUNCTION_DEVIATION "J-dev"
 	#define MSG_VZ_JERK "Vz-jerk"
 	#define MSG_VE_JERK "Ve-jerk"
 	#define MSG_VMAX "Vmax "
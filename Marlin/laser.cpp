@@ -22,8 +22,81 @@
 #include "Marlin.h"
 #include "laser.h"
 #include "planner.h"
+#include "ConfigurationStore.h"
+#ifdef LASER_CALIBRATION
+#include "temperature.h"
+#include "ultralcd.h"
+#endif
 
 laser_t laser;
+#ifdef LASER_CALIBRATION
+unsigned int laser_calibration[LASER_CALIBRATION_POINTS];
+#endif
+
+#ifdef LASER_LIFETIME
+#define LASER_LIFETIME_TICKS_16S (F_CPU / 1024) // Timer0 overflows in 16 s, 15625 at 16 MHz
+
+// The lifetime only grows, so the valid slot with the largest count is the newest one
+typedef struct {
+  unsigned long seconds;
+  unsigned long check; // ~seconds, a slot torn by a reset during its write is skipped
+} laser_lifetime_slot_t;
+
+#define LASER_LIFETIME_SLOT(i) ((laser_lifetime_slot_t*)(LASER_LIFETIME_EEPROM_OFFSET + (i) * sizeof(laser_lifetime_slot_t)))
+
+static uint8_t laser_lifetime_slot; // slot of the last save
+static unsigned long laser_lifetime_saved;
+
+static void laser_lifetime_load() {
+  eeprom_write_flush();
+  laser.lifetime = 0;
+  laser_lifetime_slot = LASER_LIFETIME_SLOTS - 1;
+  for (uint8_t i = 0; i < LASER_LIFETIME_SLOTS; i++) {
+    laser_lifetime_slot_t slot;
+    eeprom_read_block(&slot, LASER_LIFETIME_SLOT(i), sizeof(slot));
+    if (slot.check == ~slot.seconds && slot.seconds >= laser.lifetime) {
+      laser.lifetime = slot.seconds;
+      laser_lifetime_slot = i;
+    }
+  }
+  laser_lifetime_saved = laser.lifetime;
+}
+
+void laser_lifetime_save() {
+  laser_lifetime_slot_t slot = { laser.lifetime, ~laser.lifetime };
+  if (++laser_lifetime_slot >= LASER_LIFETIME_SLOTS) laser_lifetime_slot = 0;
+  int pos = (int)LASER_LIFETIME_SLOT(laser_lifetime_slot);
+  _EEPROM_writeData(pos, (uint8_t*)&slot, sizeof(slot));
+  laser_lifetime_saved = laser.lifetime;
+}
+
+// Called from the main loop. Moves the on time counted at the laser edges, and so far of a firing in progress,
+// into the lifetime, and saves it after every LASER_LIFETIME_SAVE_INTERVAL of on time.
+void laser_lifetime_update() {
+  CRITICAL_SECTION_START;
+  if (laser.firing == LASER_ON) {
+    unsigned long now = timer0_overflow_count;
+    laser.on_ticks += now - laser.fired_ticks;
+    laser.fired_ticks = now;
+  }
+  while (laser.on_ticks >= LASER_LIFETIME_TICKS_16S) {
+    laser.on_ticks -= LASER_LIFETIME_TICKS_16S;
+    laser.lifetime += 16;
+  }
+  CRITICAL_SECTION_END;
+  if (laser.lifetime - laser_lifetime_saved >= LASER_LIFETIME_SAVE_INTERVAL) laser_lifetime_save();
+}
+
+// Writes every slot, a lower count would not be taken as the newest one otherwise
+void laser_lifetime_set(unsigned long seconds) {
+  CRITICAL_SECTION_START;
+  laser.on_ticks = 0;
+  laser.fired_ticks = timer0_overflow_count;
+  CRITICAL_SECTION_END;
+  laser.lifetime = seconds;
+  for (uint8_t i = 0; i < LASER_LIFETIME_SLOTS; i++) laser_lifetime_save();
+}
+#endif // LASER_LIFETIME
 
 void laser_init()
 {
@@ -58,7 +131,10 @@ void laser_init()
     laser.peel_speed = 2.0;
     laser.peel_pause = 0.0;
   #endif // MUVE_Z_PEEL
-
+  #ifdef LASER_LIFETIME
+    laser.on_ticks = 0;
+    laser_lifetime_load();
+  #endif // LASER_LIFETIME
 }
 
 void laser_pulse_init() {
@@ -81,15 +157,101 @@ void laser_pulse_init() {
 }
 
 #if LASER_CONTROL == 1
-unsigned long calc_laser_intensity(float intensity) {
+static unsigned long laser_duty(float intensity) {
   if (intensity > 100.0) intensity = 100.0; // restrict intensity between 0 and 255
   if (intensity < 0.0) intensity = 0.0;
   return labs(intensity*2.55);
 }
 #else
-unsigned long calc_laser_intensity(float intensity) {
+static unsigned long laser_duty(float intensity) {
   if (intensity > 100.0) intensity = 100.0; // restrict intensity between 0 and 255
   if (intensity < 0.0) intensity = 0.0;
   return labs((intensity / 100.0)*(F_CPU / LASER_PWM));
 }
 #endif
+
+#ifdef LASER_CALIBRATION
+#define LASER_CALIBRATION_STEP (100.0 / (LASER_CALIBRATION_POINTS - 1))
+
+// Inverse of the measured curve: the duty cycle that gives the asked share of the full output.
+// Below the lasing threshold the curve is flat, so small intensities land just above it.
+static float laser_calibrated(float intensity) {
+  unsigned int full = laser_calibration[LASER_CALIBRATION_POINTS - 1];
+  if (intensity <= 0.0 || intensity >= 100.0 || full == 0) return intensity;
+  float wanted = intensity * full / 100.0;
+  uint8_t i;
+  for (i = 1; i < LASER_CALIBRATION_POINTS - 1; i++)
+    if (laser_calibration[i] >= wanted) break;
+  unsigned int lo = laser_calibration[i-1];
+  unsigned int hi = laser_calibration[i];
+  if (hi <= lo) return i * LASER_CALIBRATION_STEP;
+  return (i - 1 + (wanted - lo) / (hi - lo)) * LASER_CALIBRATION_STEP;
+}
+
+// A straight line, the same as no calibration
+void laser_calibration_reset() {
+  for (uint8_t i = 0; i < LASER_CALIBRATION_POINTS; i++)
+    laser_calibration[i] = (unsigned long)i * OVERSAMPLENR * 1023 / (LASER_CALIBRATION_POINTS - 1);
+}
+
+// Falls back to the straight line when the curve is not usable, e.g. read from a blank EEPROM
+bool laser_calibration_check() {
+  bool ok = laser_calibration[0] == 0 && laser_calibration[LASER_CALIBRATION_POINTS - 1] > 0;
+  for (uint8_t i = 1; ok && i < LASER_CALIBRATION_POINTS; i++)
+    if (laser_calibration[i] < laser_calibration[i-1] || laser_calibration[i] > OVERSAMPLENR * 1023) ok = false;
+  if (!ok) laser_calibration_reset();
+  return ok;
+}
+
+static unsigned int laser_read_photodiode() {
+  #if HAS_PHOTODIODE
+    // The LASER_ONLY monitor owns the ADC and samples the photodiode with the thermistors
+    return rawPhotodiode();
+  #else
+    // The temperature ISR is not running on a laser machine, the ADC is free
+    unsigned int raw = 0;
+    for (uint8_t i = 0; i < OVERSAMPLENR; i++)
+      raw += analogRead(LASER_PHOTODIODE_PIN);
+    return raw;
+  #endif
+}
+
+// Fires the laser at each calibration point for settle ms, then measures it. The first point (0%)
+// gives the ambient light. The curve is only kept when the laser was seen at full power.
+bool laser_calibrate(unsigned long settle) {
+  unsigned int measured[LASER_CALIBRATION_POINTS];
+  unsigned int ambient = 0;
+
+  for (uint8_t i = 0; i < LASER_CALIBRATION_POINTS; i++) {
+    laser_fire(laser_duty(i * LASER_CALIBRATION_STEP));
+    unsigned long codenum = millis() + settle;
+    while (millis() < codenum) {
+      manage_heater();
+      manage_inactivity();
+      lcd_update();
+    }
+    unsigned int raw = laser_read_photodiode();
+    laser_extinguish();
+
+    if (i == 0) ambient = raw;
+    raw = (raw > ambient) ? raw - ambient : 0;
+    measured[i] = (i > 0 && raw < measured[i-1]) ? measured[i-1] : raw;
+
+    SERIAL_ECHO_START;
+    SERIAL_ECHOPAIR("Laser calibration ", i * LASER_CALIBRATION_STEP);
+    SERIAL_ECHOPAIR("%: ", (unsigned long)raw);
+    SERIAL_ECHOLN("");
+  }
+
+  if (measured[LASER_CALIBRATION_POINTS - 1] < OVERSAMPLENR * 8) return false;
+  memcpy(laser_calibration, measured, sizeof(laser_calibration));
+  return true;
+}
+#endif // LASER_CALIBRATION
+
+unsigned long calc_laser_intensity(float intensity) {
+  #ifdef LASER_CALIBRATION
+    intensity = laser_calibrated(intensity);
+  #endif
+  return laser_duty(intensity);
+}
@@ -29,6 +29,7 @@ typedef struct {
   float intensity; // Laser firing instensity 0.0 - 100.0
   float ppm; // pulses per millimeter, for pulsed firing mode
   unsigned long duration; // laser firing duration in microseconds, for pulsed firing mode
+  unsigned long last_firing; // micros() when the laser was last fired, for the duration in continuous firing mode
   bool status; // LASER_ON / LASER_OFF - buffered
   bool firing; // LASER_ON / LASER_OFF - instantaneous
   unsigned long micron_counter; // number of microns since last fire
@@ -38,6 +39,11 @@ typedef struct {
   unsigned int micron_inc_y; // distance increment equivalent to one step in Y
   unsigned long pulse_ticks; // duration of one pulse in Timer1 ticks
   unsigned long time_counter; // counts the time the laser has been on in Timer1 ticks
+  #ifdef LASER_LIFETIME
+    unsigned long fired_ticks; // Timer0 overflow count at the last laser_fire()
+    unsigned long on_ticks; // on time not yet added to the lifetime, in Timer0 overflows
+    unsigned long lifetime; // total on time of the diode in seconds
+  #endif // LASER_LIFETIME
   #ifdef MUVE_Z_PEEL
     float peel_distance;
     float peel_speed;
@@ -53,6 +59,23 @@ unsigned long calc_laser_intensity(float intensity);
 void laser_fire(unsigned long intensity);
 void laser_extinguish();
 
+#ifdef LASER_LIFETIME
+// Counted by the Arduino core for millis(), one every 64 * 256 CPU clocks (1.024 ms at 16 MHz)
+extern "C" volatile unsigned long timer0_overflow_count;
+void laser_lifetime_update();
+void laser_lifetime_save();
+void laser_lifetime_set(unsigned long seconds);
+#endif
+
+#ifdef LASER_CALIBRATION
+// Measured optical output at 0%, 100/(LASER_CALIBRATION_POINTS-1)%, ... 100% duty cycle, in photodiode ADC counts
+// (sum of OVERSAMPLENR samples). It never decreases and starts at 0, the ambient light is taken off.
+extern unsigned int laser_calibration[LASER_CALIBRATION_POINTS];
+void laser_calibration_reset();
+bool laser_calibration_check();
+bool laser_calibrate(unsigned long settle);
+#endif
+
 // Laser constants
 #define LASER_OFF 0
 #define LASER_ON 1
@@ -61,8 +84,14 @@ FORCE_INLINE void laser_fire(unsigned long intensity){
   static unsigned long prev_intensity;
 
   if (laser.firing == LASER_OFF) {
+    #ifdef LASER_LIFETIME
+      CRITICAL_SECTION_START;
+      laser.fired_ticks = timer0_overflow_count;
+      CRITICAL_SECTION_END;
+    #endif
     laser.firing = LASER_ON;
     #if LASER_CONTROL == 1
+      laser.last_firing = micros();
       analogWrite(LASER_FIRING_PIN, intensity);
     #elif LASER_CONTROL == 3
       WRITE(LASER_POWER_PIN, HIGH);
@@ -82,6 +111,11 @@ FORCE_INLINE void laser_extinguish() {
     #if LASER_CONTROL == 3
     digitalWrite(LASER_POWER_PIN, 0);
     #endif
+    #ifdef LASER_LIFETIME
+      CRITICAL_SECTION_START;
+      laser.on_ticks += timer0_overflow_count - laser.fired_ticks;
+      CRITICAL_SECTION_END;
+    #endif
 
     #if LASER_DIAGNOSTICS
       SERIAL_ECHOLN("*E");
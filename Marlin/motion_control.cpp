@@ -46,7 +46,16 @@ void mc_arc(float *position, float *target, float *offset, uint8_t axis_0, uint8
   
   float millimeters_of_travel = hypot(angular_travel*radius, fabs(linear_travel));
   if (millimeters_of_travel < 0.001) { return; }
+#ifdef ARC_CHORD_TOLERANCE
+  // A chord of length c on a circle of radius r is sagitta s away from it at the middle: c = 2 * sqrt(s * (2r - s))
+  float mm_per_arc_segment = MIN_MM_PER_ARC_SEGMENT;
+  if (radius > ARC_CHORD_TOLERANCE)
+    mm_per_arc_segment = constrain(2 * sqrt(ARC_CHORD_TOLERANCE * (2 * radius - ARC_CHORD_TOLERANCE)),
+      MIN_MM_PER_ARC_SEGMENT, MAX_MM_PER_ARC_SEGMENT);
+  uint16_t segments = ceil(fabs(angular_travel * radius) / mm_per_arc_segment);
+#else
   uint16_t segments = floor(millimeters_of_travel/MM_PER_ARC_SEGMENT);
+#endif
   if(segments == 0) segments = 1;
   
   /*  
@@ -85,8 +94,14 @@ void mc_arc(float *position, float *target, float *offset, uint8_t axis_0, uint8
      This is important when there are successive arc motions. 
   */
   // Vector rotation matrix values
+#ifdef ARC_CHORD_TOLERANCE
+  // The chords of small circles span too large an angle for the small angle approximation
+  float cos_T = cos(theta_per_segment);
+  float sin_T = sin(theta_per_segment);
+#else
   float cos_T = 1-0.5*theta_per_segment*theta_per_segment; // Small angle approximation
   float sin_T = theta_per_segment;
+#endif
   
   float arc_target[4];
   float sin_Ti;
@@ -135,3 +150,96 @@ void mc_arc(float *position, float *target, float *offset, uint8_t axis_0, uint8
   //   plan_set_acceleration_manager_enabled(acceleration_manager_was_enabled);
 }
 
+#ifdef BEZIER_CURVE_SUPPORT
+// Fixed point units, 1/16 um. The fraction keeps the rounding of the halvings from adding up to more
+// than the tolerance.
+#define BEZIER_UNITS_PER_MM 16000
+
+// The second half of a halving, waiting while the first half is drawn. Its first control point is where the
+// first half ends, so only the other three are kept.
+typedef struct {
+  long p[3][2];
+  uint8_t depth;
+} bezier_half_t;
+
+// With u = 3p1 - 2p0 - p3 and v = 3p2 - p0 - 2p3 the piece stays within |max(u, v)| / 4 of its chord, where
+// max is taken per coordinate. Checking every coordinate against 4 / sqrt(2) times BEZIER_TOLERANCE keeps it
+// within the tolerance without squaring anything.
+#define BEZIER_FLATNESS ((long)(BEZIER_TOLERANCE * BEZIER_UNITS_PER_MM * 2.828))
+
+static bool bezier_flat(long p[4][2])
+{
+  for (uint8_t axis = 0; axis < 2; axis++) {
+    if (labs(3 * p[1][axis] - 2 * p[0][axis] - p[3][axis]) > BEZIER_FLATNESS) return false;
+    if (labs(3 * p[2][axis] - p[0][axis] - 2 * p[3][axis]) > BEZIER_FLATNESS) return false;
+  }
+  return true;
+}
+
+// The curve is flattened by de Casteljau subdivision at t = 1/2, which only needs additions and shifts
+// in fixed point. The piece being drawn keeps its first half, the second one waits. At most one second half
+// per depth waits at a time, the deepest is drawn next, so the lines come out in order. plan_buffer_line()
+// waits inside this frame while the buffer is full, it takes about 75 + 25 * BEZIER_MAX_DEPTH bytes of stack.
+void mc_bezier(float *position, float *target, float *offset, float feed_rate, uint8_t extruder)
+{
+  // Control points relative to the start of the curve
+  long p[4][2];
+  p[0][0] = 0;
+  p[0][1] = 0;
+  p[1][0] = lround(offset[0] * BEZIER_UNITS_PER_MM);
+  p[1][1] = lround(offset[1] * BEZIER_UNITS_PER_MM);
+  p[3][0] = lround((target[X_AXIS] - position[X_AXIS]) * BEZIER_UNITS_PER_MM);
+  p[3][1] = lround((target[Y_AXIS] - position[Y_AXIS]) * BEZIER_UNITS_PER_MM);
+  p[2][0] = p[3][0] + lround(offset[2] * BEZIER_UNITS_PER_MM);
+  p[2][1] = p[3][1] + lround(offset[3] * BEZIER_UNITS_PER_MM);
+  uint8_t depth = 0;
+  unsigned long t = 0; // The curve parameter at the start of the piece, 0x10000 is the end of the curve
+  bezier_half_t waiting[BEZIER_MAX_DEPTH];
+  uint8_t waiting_count = 0;
+
+  float bezier_target[4];
+  for (;;) {
+    if (depth < BEZIER_MAX_DEPTH && !bezier_flat(p)) {
+      bezier_half_t *second = &waiting[waiting_count++];
+      for (uint8_t axis = 0; axis < 2; axis++) {
+        long m01 = (p[0][axis] + p[1][axis]) >> 1;
+        long m12 = (p[1][axis] + p[2][axis]) >> 1;
+        long m23 = (p[2][axis] + p[3][axis]) >> 1;
+        long m012 = (m01 + m12) >> 1;
+        long m123 = (m12 + m23) >> 1;
+        long mid = (m012 + m123) >> 1;
+        second->p[0][axis] = m123;
+        second->p[1][axis] = m23;
+        second->p[2][axis] = p[3][axis];
+        p[1][axis] = m01;
+        p[2][axis] = m012;
+        p[3][axis] = mid;
+      }
+      second->depth = ++depth;
+      continue;
+    }
+
+    if (waiting_count == 0)
+      break;  // The last piece, it ends at the target itself
+    t += 0x10000UL >> depth;
+    float t_end = t / 65536.0;
+    bezier_target[X_AXIS] = position[X_AXIS] + p[3][0] / (float)BEZIER_UNITS_PER_MM;
+    bezier_target[Y_AXIS] = position[Y_AXIS] + p[3][1] / (float)BEZIER_UNITS_PER_MM;
+    bezier_target[Z_AXIS] = position[Z_AXIS] + (target[Z_AXIS] - position[Z_AXIS]) * t_end;
+    bezier_target[E_AXIS] = position[E_AXIS] + (target[E_AXIS] - position[E_AXIS]) * t_end;
+    clamp_to_software_endstops(bezier_target);
+    plan_buffer_line(bezier_target[X_AXIS], bezier_target[Y_AXIS], bezier_target[Z_AXIS], bezier_target[E_AXIS], feed_rate, extruder);
+
+    bezier_half_t *second = &waiting[--waiting_count];
+    for (uint8_t axis = 0; axis < 2; axis++) {
+      p[0][axis] = p[3][axis];
+      p[1][axis] = second->p[0][axis];
+      p[2][axis] = second->p[1][axis];
+      p[3][axis] = second->p[2][axis];
+    }
+    depth = second->depth;
+  }
+  // Ensure last segment arrives at target location.
+  plan_buffer_line(target[X_AXIS], target[Y_AXIS], target[Z_AXIS], target[E_AXIS], feed_rate, extruder);
+}
+#endif // BEZIER_CURVE_SUPPORT
@@ -28,5 +28,12 @@
 // for vector transformation direction.
 void mc_arc(float *position, float *target, float *offset, unsigned char axis_0, unsigned char axis_1,
   unsigned char axis_linear, float feed_rate, float radius, unsigned char isclockwise, uint8_t extruder);
+
+#ifdef BEZIER_CURVE_SUPPORT
+// Execute a cubic Bezier curve in the XY plane from position to target. offset holds the first control
+// point relative to position and the second one relative to target: {I, J, P, Q}. Z and E are moved
+// along with the curve parameter.
+void mc_bezier(float *position, float *target, float *offset, float feed_rate, uint8_t extruder);
+#endif
   
 #endif
@@ -393,6 +393,7 @@
 
 	#if LASER_CONTROL == 1
       #define LASER_FIRING_PIN    9
+      #define LASER_FIRING_OCR    OCR2B // compare register of D9, LASER_CONSTANT_ENERGY writes it from the stepper ISR
       #endif
 	#if LASER_CONTROL == 2
       #define LASER_INTENSITY_PIN 6
@@ -470,6 +471,14 @@
   #endif
   #define TEMP_BED_PIN       14   // ANALOG NUMBERING
 
+  #if MOTHERBOARD == 35 && defined(LASER_ONLY)
+    #define LASER_TEMP_PIN     13   // ANALOG NUMBERING, laser diode heatsink on the T0 header
+    #define VAT_TEMP_PIN       14   // ANALOG NUMBERING, resin vat on the T2 header
+    #define VAT_HEATER_PIN     -1   // D8-D10 are taken, e.g. 5 on the servo header through an external MOSFET or SSR
+  #endif
+  #if MOTHERBOARD == 35 && defined(LASER)
+    #define LASER_PHOTODIODE_PIN 15 // ANALOG NUMBERING, photodiode for M653 on the T1 header, mind its 4.7k pullup
+  #endif
 
 
   #ifdef NUM_SERVOS
@@ -2192,6 +2201,10 @@
 #define Z_MIN_PIN          -1
 #endif
 
+#if defined(LASER_CALIBRATION) && (!defined(LASER_PHOTODIODE_PIN) || LASER_PHOTODIODE_PIN < 0)
+  #error "LASER_CALIBRATION needs a photodiode, set LASER_PHOTODIODE_PIN for your board or disable LASER_CALIBRATION"
+#endif
+
 #define SENSITIVE_PINS {0, 1, X_STEP_PIN, X_DIR_PIN, X_ENABLE_PIN, X_MIN_PIN, X_MAX_PIN, Y_STEP_PIN, Y_DIR_PIN, Y_ENABLE_PIN, Y_MIN_PIN, Y_MAX_PIN, Z_STEP_PIN, Z_DIR_PIN, Z_ENABLE_PIN, Z_MIN_PIN, Z_MAX_PIN, PS_ON_PIN, \
                         HEATER_BED_PIN, FAN_PIN,                  \
                         _E0_PINS _E1_PINS _E2_PINS             \
@@ -54,11 +54,14 @@
 #include "Marlin.h"
 #include "planner.h"
 #include "stepper.h"
-#ifndef LASER
+#if !defined(LASER) || defined(LASER_ONLY)
 #include "temperature.h"
 #endif
 #include "ultralcd.h"
 #include "language.h"
+#ifdef PLATE_TILT_COMPENSATION
+#include "vector_3.h"
+#endif
 
 //===========================================================================
 //=============================public variables ============================
@@ -74,13 +77,55 @@ float retract_acceleration; //  mm/s^2   filament pull-pack and push-forward  wh
 float max_xy_jerk; //speed than can be stopped at once, if i understand correctly.
 float max_z_jerk;
 float max_e_jerk;
+#ifdef JUNCTION_DEVIATION
+float junction_deviation;
+#endif
+#ifdef PRINT_PROGRESS
+float planned_time = 0;
+#endif
 float mintravelfeedrate;
 unsigned long axis_steps_per_sqr_second[NUM_AXIS];
 
+// Derived from the settings above by reset_acceleration_rates()
+static float axis_mm_per_step[NUM_AXIS];
+static unsigned char acceleration_limited_axes;  // Axes with a max acceleration not above the acceleration
+
+#ifdef XY_CORRECTION
+int xy_correction[XY_CORRECTION_POINTS_Y][XY_CORRECTION_POINTS_X][2];
+bool xy_correction_active = false;
+// The map in steps, worked out by reset_xy_correction()
+static int xy_correction_steps[XY_CORRECTION_POINTS_Y][XY_CORRECTION_POINTS_X][2];
+static long xy_correction_origin[2]; // steps of the first point
+static long xy_correction_span[2]; // steps from the first to the last point
+static unsigned long xy_correction_scale[2]; // 2^24 * cells / xy_correction_span
+#endif
+
+#ifdef PLATE_TILT_COMPENSATION
+float plate_tilt[3][3];
+bool plate_tilt_active = false;
+// The height of the plane at each Z motor in its own steps, worked out by reset_plate_tilt(). The second
+// motor is the E one with MUVE_Z_PEEL.
+#ifdef MUVE_Z_PEEL
+  #define PLATE_TILT_MOTORS 2
+#else
+  #define PLATE_TILT_MOTORS 1
+#endif
+static long plate_tilt_offset[PLATE_TILT_MOTORS];
+static long plate_tilt_logical[PLATE_TILT_MOTORS]; // the uncorrected target of position[], in steps
+static bool plate_tilt_known = false; // plate_tilt_logical[] is lost when a Z motor stops short of position[]
+#endif
+
 // The current position of the tool in absolute steps
 long position[4];   //rescaled from extern when axis_steps_per_unit are changed by gcode
 static float previous_speed[4]; // Speed of previous path line segment
 static float previous_nominal_speed; // Nominal speed of previous path line segment
+static unsigned char previous_nominal_loops = 1; // Steps per interrupt at the nominal rate of the previous segment
+#ifdef LIVE_FEEDRATE_OVERRIDE
+static int planned_feedmultiply = 100; // The feedmultiply the queued moves are planned with
+#endif
+#ifdef JUNCTION_DEVIATION
+static float previous_unit_vec[4]; // Direction of previous path line segment
+#endif
 
 #ifdef AUTOTEMP
 float autotemp_max=250;
@@ -109,6 +154,17 @@ static unsigned char old_direction_bits = 0;               // Old direction bits
 static long x_segment_time[3]={MAX_FREQ_TIME + 1,0,0};     // Segment times (in us). Used for speed calculations
 static long y_segment_time[3]={MAX_FREQ_TIME + 1,0,0};
 #endif
+#ifdef FIXED_POINT_PLANNER
+// Step length of each axis as a 16 bit mantissa in units of 2^-length_unit_shift mm
+static unsigned short length_per_step[NUM_AXIS];
+static int8_t length_unit_shift[NUM_AXIS];
+static unsigned short max_step_rate[NUM_AXIS]; // max_feedrate in steps/s, divided by 2^max_step_rate_shift
+static unsigned char max_step_rate_shift;        // to fit the highest one in 16 bits
+// 2^24 / (F_CPU/8), from steps/s^2 to the acceleration_rate of the stepper
+#define ACCELERATION_RATE_FACTOR (16777216.0 / (F_CPU / 8.0))
+#define ACCELERATION_RATE_INT ((unsigned long)ACCELERATION_RATE_FACTOR)
+#define ACCELERATION_RATE_FRACTION ((unsigned short)((ACCELERATION_RATE_FACTOR - ACCELERATION_RATE_INT) * 65536.0 + 0.5))
+#endif
 
 // Returns the index of the next block in the ring buffer
 // NOTE: Removed modulo (%) operator, which uses an expensive divide and multiplication.
@@ -130,6 +186,72 @@ static int8_t prev_block_index(int8_t block_index) {
   return(block_index);
 }
 
+#ifdef FIXED_POINT_PLANNER
+// Integer square root, rounded to the nearest
+static unsigned short isqrt(unsigned long x)
+{
+  unsigned long root = 0;
+  unsigned long bit = 1UL << 30;
+  while (bit > x) bit >>= 2;
+  while (bit != 0) {
+    if (x >= root + bit) {
+      x -= root + bit;
+      root = (root >> 1) + bit;
+    }
+    else
+      root >>= 1;
+    bit >>= 2;
+  }
+  if (x > root) root++;
+  return root;
+}
+
+// Length in mm of a vector with the components a[i] * 2^exponent[i]. They are brought to a common exponent
+// that leaves the largest one 15 bits, so the sum of up to four squares fits in 32 bits.
+static float fixed_length(const unsigned long *a, const int8_t *exponent, unsigned char axes)
+{
+  int8_t top = -128;
+  for (unsigned char i = 0; i < axes; i++) {
+    if (a[i] == 0) continue;
+    unsigned long m = a[i];
+    int8_t e = exponent[i];
+    while (m > 0x7FFF) { m >>= 1; e++; }
+    while (m < 0x4000) { m <<= 1; e--; }
+    if (e > top) top = e;
+  }
+  if (top == -128) return 0;
+  unsigned long sum = 0;
+  for (unsigned char i = 0; i < axes; i++) {
+    if (a[i] == 0) continue;
+    int8_t shift = top - exponent[i];
+    unsigned short c = shift >= 32 ? 0 : shift >= 0 ? a[i] >> shift : a[i] << -shift;
+    sum += (unsigned long)c * c;
+  }
+  return ldexp(isqrt(sum), top);
+}
+
+// a * 2^a_shift > b * 2^b_shift, the shifts are at most 16 apart
+static bool scaled_greater(unsigned long a, int8_t a_shift, unsigned long b, int8_t b_shift)
+{
+  if (a_shift > b_shift)
+    b >>= a_shift - b_shift;
+  else
+    a >>= b_shift - a_shift;
+  return a > b;
+}
+
+// True if acceleration_st * steps * 2^shift / step_event_count is above limit, with 16x16 bit multiplies
+static bool axis_acceleration_exceeded(unsigned long acceleration_st, unsigned short steps, int8_t shift, unsigned short step_event_count, unsigned long limit)
+{
+  if (acceleration_st <= limit) return false;
+  while (acceleration_st > 0xFFFF) {
+    acceleration_st >>= 1;
+    limit >>= 1;
+  }
+  return scaled_greater((unsigned long)(unsigned short)acceleration_st * steps, shift, (unsigned long)(unsigned short)limit * step_event_count, 0);
+}
+#endif
+
 //===========================================================================
 //=============================functions         ============================
 //===========================================================================
@@ -163,11 +285,40 @@ FORCE_INLINE float intersection_distance(float initial_rate, float final_rate, f
   }
 }
 
+#ifdef LASER_CONSTANT_ENERGY
+// laser_intensity * step_rate / nominal_rate is (step_rate << shift) * factor >> 24 for MultiU24X24toH16(). Slow
+// exposure moves have an intensity above the nominal rate, the shift keeps their factor within 24 bits.
+static unsigned long calc_laser_ramp_factor(unsigned long intensity, unsigned long nominal_rate, unsigned char &shift)
+{
+  shift = 0;
+  while (shift < 8 && (nominal_rate << shift) <= intensity) shift++; // intensity is at most 255
+  return (intensity << (24 - shift)) / nominal_rate;
+}
+#endif
+
 // Calculates trapezoid parameters so that the entry- and exit-speed is compensated by the provided factors.
 
 void calculate_trapezoid_for_block(block_t *block, float entry_factor, float exit_factor) {
-  unsigned long initial_rate = ceil(block->nominal_rate*entry_factor); // (step/min)
-  unsigned long final_rate = ceil(block->nominal_rate*exit_factor); // (step/min)
+  unsigned long nominal_rate = block->nominal_rate;
+#ifdef LIVE_FEEDRATE_OVERRIDE
+  // A rescaled nominal rate goes to the stepper with the trapezoid that was planned for it
+  unsigned char nominal_changed = block->nominal_changed;
+  unsigned char nominal_loops = block->nominal_loops;
+  unsigned short nominal_timer;
+  #ifdef LASER_CONSTANT_ENERGY
+    unsigned long laser_ramp_factor;
+    unsigned char laser_ramp_shift;
+  #endif
+  if (nominal_changed) {
+    nominal_rate = ceil(block->step_event_count * block->nominal_speed / block->millimeters);
+    nominal_timer = calc_step_timer(nominal_rate, nominal_loops);
+    #ifdef LASER_CONSTANT_ENERGY
+      laser_ramp_factor = calc_laser_ramp_factor(block->laser_intensity, nominal_rate, laser_ramp_shift);
+    #endif
+  }
+#endif // LIVE_FEEDRATE_OVERRIDE
+  unsigned long initial_rate = ceil(nominal_rate*entry_factor); // (step/min)
+  unsigned long final_rate = ceil(nominal_rate*exit_factor); // (step/min)
 
   // Limit minimal step rate (Otherwise the timer will overflow.)
   if(initial_rate <120) {
@@ -179,9 +330,9 @@ void calculate_trapezoid_for_block(block_t *block, float entry_factor, float exi
 
   long acceleration = block->acceleration_st;
   int32_t accelerate_steps =
-    ceil(estimate_acceleration_distance(block->initial_rate, block->nominal_rate, acceleration));
+    ceil(estimate_acceleration_distance(block->initial_rate, nominal_rate, acceleration));
   int32_t decelerate_steps =
-    floor(estimate_acceleration_distance(block->nominal_rate, block->final_rate, -acceleration));
+    floor(estimate_acceleration_distance(nominal_rate, block->final_rate, -acceleration));
 
   // Calculate the size of Plateau of Nominal Rate.
   int32_t plateau_steps = block->step_event_count-accelerate_steps-decelerate_steps;
@@ -201,6 +352,41 @@ void calculate_trapezoid_for_block(block_t *block, float entry_factor, float exi
   volatile long final_advance = block->advance*exit_factor*exit_factor;
 #endif // ADVANCE
 
+#ifdef S_CURVE_ACCELERATION
+  // The Bezier ramps are laid out in time, they take as long as the linear ramps so they cover the same steps
+  unsigned long cruise_rate = nominal_rate;
+  if (plateau_steps == 0)
+    cruise_rate = min(cruise_rate, (unsigned long)sqrt((float)initial_rate*initial_rate + 2.0*acceleration*accelerate_steps));
+  if (cruise_rate < initial_rate) cruise_rate = initial_rate;
+  if (cruise_rate < final_rate) cruise_rate = final_rate;
+  unsigned long acceleration_ticks = (cruise_rate - initial_rate) * (F_CPU / 8.0) / acceleration;
+  unsigned long deceleration_ticks = (cruise_rate - final_rate) * (F_CPU / 8.0) / acceleration;
+  unsigned char acceleration_shift = 0, deceleration_shift = 0;
+  while ((acceleration_ticks >> acceleration_shift) > 0xFFFF) acceleration_shift++;
+  while ((deceleration_ticks >> deceleration_shift) > 0xFFFF) deceleration_shift++;
+  unsigned long acceleration_inverse = 0xFFFFFFFFUL / max(acceleration_ticks >> acceleration_shift, 1UL);
+  unsigned long deceleration_inverse = 0xFFFFFFFFUL / max(deceleration_ticks >> deceleration_shift, 1UL);
+#endif // S_CURVE_ACCELERATION
+
+  // The stepper starts the block with this, the table lookup is done here instead of in the ISR
+  unsigned char initial_loops = 1;
+  unsigned short initial_timer = calc_step_timer(initial_rate, initial_loops);
+
+#ifdef PRINT_PROGRESS
+  // Time of the ramps and the plateau. Without a plateau the ramps meet below the nominal rate.
+  float estimated_time;
+  if (acceleration > 0) {
+    float peak_rate = nominal_rate;
+    if (plateau_steps == 0)
+      peak_rate = min(peak_rate, sqrt((float)initial_rate*initial_rate + 2.0*acceleration*accelerate_steps));
+    peak_rate = max(peak_rate, (float)max(initial_rate, final_rate));
+    estimated_time = (2*peak_rate - initial_rate - final_rate) / acceleration + plateau_steps / peak_rate;
+  }
+  else
+    estimated_time = (float)block->step_event_count / nominal_rate;
+  bool estimate_changed = false;
+#endif // PRINT_PROGRESS
+
   // block->accelerate_until = accelerate_steps;
   // block->decelerate_after = accelerate_steps+plateau_steps;
   CRITICAL_SECTION_START;  // Fill variables used by the stepper in a critical section
@@ -209,12 +395,44 @@ void calculate_trapezoid_for_block(block_t *block, float entry_factor, float exi
     block->decelerate_after = accelerate_steps+plateau_steps;
     block->initial_rate = initial_rate;
     block->final_rate = final_rate;
+    block->initial_timer = initial_timer;
+    block->initial_loops = initial_loops;
+#ifdef LIVE_FEEDRATE_OVERRIDE
+    if (nominal_changed) {
+      block->nominal_rate = nominal_rate;
+      block->nominal_timer = nominal_timer;
+      block->nominal_loops = nominal_loops;
+      #ifdef LASER_CONSTANT_ENERGY
+        block->laser_ramp_factor = laser_ramp_factor;
+        block->laser_ramp_shift = laser_ramp_shift;
+      #endif
+      block->nominal_changed = false;
+    }
+#endif // LIVE_FEEDRATE_OVERRIDE
 #ifdef ADVANCE
     block->initial_advance = initial_advance;
     block->final_advance = final_advance;
 #endif //ADVANCE
+#ifdef S_CURVE_ACCELERATION
+    block->cruise_rate = cruise_rate;
+    block->acceleration_ticks = acceleration_ticks;
+    block->deceleration_ticks = deceleration_ticks;
+    block->acceleration_inverse = acceleration_inverse;
+    block->deceleration_inverse = deceleration_inverse;
+    block->acceleration_shift = acceleration_shift;
+    block->deceleration_shift = deceleration_shift;
+#endif //S_CURVE_ACCELERATION
+#ifdef PRINT_PROGRESS
+    estimate_changed = true;
+#endif
   }
   CRITICAL_SECTION_END;
+#ifdef PRINT_PROGRESS
+  if (estimate_changed) {
+    planned_time += estimated_time - block->estimated_time;
+    block->estimated_time = estimated_time;
+  }
+#endif
 }
 
 // Calculates the maximum allowable speed at this point when you must be able to reach target_velocity using the
@@ -515,24 +733,133 @@ void check_axes_activity()
 }
 
 
-float junction_deviation = 0.1;
 // Add a new linear movement to the buffer. steps_x, _y and _z is the absolute position in
 // mm. Microseconds specify how many microseconds the move should take to perform. To aid acceleration
 // calculation the caller must also provide the physical length of the line in millimeters.
+#ifdef LIVE_FEEDRATE_OVERRIDE
+// Rescales the queued moves when feedmultiply has changed since they were planned. prepare_move()
+// applies it to moves with X or Y motion, so only those are rescaled. The stepper may be running the
+// block at the tail and the entry of the next one is tied to its exit, both are left alone. The new
+// nominal rates reach the stepper with the recalculated trapezoids, see calculate_trapezoid_for_block().
+void plan_apply_feedmultiply()
+{
+  if (feedmultiply == planned_feedmultiply)
+    return;
+  float factor = (float)feedmultiply / planned_feedmultiply;
+  planned_feedmultiply = feedmultiply;
+
+  CRITICAL_SECTION_START;
+  unsigned char block_index = block_buffer_tail;
+  CRITICAL_SECTION_END;
+  for (unsigned char i = 0; i < 2 && block_index != block_buffer_head; i++)
+    block_index = next_block_index(block_index);
+  if (block_index == block_buffer_head)
+    return;
+
+  block_t *previous = &block_buffer[prev_block_index(block_index)];
+  while (block_index != block_buffer_head) {
+    block_t *block = &block_buffer[block_index];
+    if (block->steps_x != 0 || block->steps_y != 0) {
+      float old_speed = block->nominal_speed;
+      block->requested_speed *= factor;
+      block->nominal_speed = min(block->requested_speed, block->max_nominal_speed);
+      block->nominal_changed = true;
+      block->nominal_length_flag =
+        block->nominal_speed <= max_allowable_speed(-block->acceleration, MINIMUM_PLANNER_SPEED, block->millimeters);
+      if (next_block_index(block_index) == block_buffer_head) {
+        // The junction to the next move is worked out from these
+        for (unsigned char axis = 0; axis < 4; axis++)
+          previous_speed[axis] *= block->nominal_speed / old_speed;
+        previous_nominal_speed = block->nominal_speed;
+      }
+    }
+    // Junctions only get slower here, a faster override gives faster cruising but the same corners
+    block->max_entry_speed = min(block->max_entry_speed, min(block->nominal_speed, previous->nominal_speed));
+    if (block->entry_speed > block->max_entry_speed)
+      block->entry_speed = block->max_entry_speed;
+    block->recalculate_flag = true;
+    previous = block;
+    block_index = next_block_index(block_index);
+  }
+  planner_recalculate();
+}
+#endif // LIVE_FEEDRATE_OVERRIDE
+
+#ifdef XY_CORRECTION
+// Position of a target along one axis of the map, in cells with a 16 bit fraction, held to the map
+static FORCE_INLINE unsigned long xy_correction_cell(uint8_t axis, long target, uint8_t cells)
+{
+  long offset = target - xy_correction_origin[axis];
+  if(offset <= 0)
+    return 0;
+  if(offset >= xy_correction_span[axis])
+    return (unsigned long)cells << 16;
+  return ((unsigned long)offset * xy_correction_scale[axis]) >> 8;
+}
+
+// Takes the map error, bilinearly interpolated in 8 bit fractions of a cell, off the X and Y steps
+static void xy_correct(long *target)
+{
+  unsigned long u = xy_correction_cell(X_AXIS, target[X_AXIS], XY_CORRECTION_POINTS_X - 1);
+  unsigned long v = xy_correction_cell(Y_AXIS, target[Y_AXIS], XY_CORRECTION_POINTS_Y - 1);
+  uint8_t i = u >> 16, j = v >> 16;
+  int fx = (u >> 8) & 0xFF, fy = (v >> 8) & 0xFF;
+  if(i == XY_CORRECTION_POINTS_X - 1) { i--; fx = 256; }
+  if(j == XY_CORRECTION_POINTS_Y - 1) { j--; fy = 256; }
+  for(uint8_t axis=X_AXIS; axis <= Y_AXIS; axis++)
+  {
+    long c00 = xy_correction_steps[j][i][axis], c10 = xy_correction_steps[j][i+1][axis];
+    long c01 = xy_correction_steps[j+1][i][axis], c11 = xy_correction_steps[j+1][i+1][axis];
+    long low = (c00 << 8) + (c10 - c00) * fx;
+    long high = (c01 << 8) + (c11 - c01) * fx;
+    target[axis] -= ((low << 8) + (high - low) * fy + 32768) >> 16;
+  }
+}
+#endif // XY_CORRECTION
+
+#ifdef PLATE_TILT_COMPENSATION
+static const uint8_t plate_tilt_axis[2] = { Z_AXIS, E_AXIS };
+
+// Takes the plate error at each Z motor off its target. A move that leaves the uncorrected target of a motor
+// where it was keeps the motor still, so the XY moves of a layer never step Z and a new error is only picked
+// up by the next layer change or peel. The uncorrected targets go to logical[].
+static void plate_tilt_correct(long *target, long *logical)
+{
+  for(uint8_t m=0; m < PLATE_TILT_MOTORS; m++)
+  {
+    uint8_t axis = plate_tilt_axis[m];
+    logical[m] = target[axis];
+    if(plate_tilt_known && target[axis] == plate_tilt_logical[m])
+      target[axis] = position[axis];
+    else if(plate_tilt_active)
+      target[axis] -= plate_tilt_offset[m];
+  }
+}
+#endif // PLATE_TILT_COMPENSATION
+
 void plan_buffer_line(const float &x, const float &y, const float &z, const float &e, float feed_rate, const uint8_t &extruder)
 {
   // Calculate the buffer head after we push this byte
   int next_buffer_head = next_block_index(block_buffer_head);
 
+#ifdef LIVE_FEEDRATE_OVERRIDE
+  // feed_rate was worked out with the feedrate override as it is now, bring the queued moves in line
+  plan_apply_feedmultiply();
+  int queued_feedmultiply = planned_feedmultiply;
+#endif
+
   // If the buffer is full: good! That means we are well ahead of the robot.
   // Rest here until there is room in the buffer.
   while(block_buffer_tail == next_buffer_head)
   {
-    #ifndef LASER
+    #if !defined(LASER) || defined(LASER_ONLY)
     manage_heater();
     #endif
     manage_inactivity();
     lcd_update();
+    #ifdef LIVE_FEEDRATE_OVERRIDE
+    plan_apply_feedmultiply();
+    #endif
   }
 
   // The target position of the tool in absolute steps
@@ -543,6 +870,14 @@ void plan_buffer_line(const float &x, const float &y, const float &z, const floa
   target[Y_AXIS] = lround(y*axis_steps_per_unit[Y_AXIS]);
   target[Z_AXIS] = lround(z*axis_steps_per_unit[Z_AXIS]);
   target[E_AXIS] = lround(e*axis_steps_per_unit[E_AXIS]);
+  #ifdef XY_CORRECTION
+  if(xy_correction_active)
+    xy_correct(target);
+  #endif
+  #ifdef PLATE_TILT_COMPENSATION
+  long tilt_logical[PLATE_TILT_MOTORS];
+  plate_tilt_correct(target, tilt_logical);
+  #endif
 
   #ifdef PREVENT_DANGEROUS_EXTRUDE
   if(target[E_AXIS]!=position[E_AXIS])
@@ -570,6 +905,9 @@ void plan_buffer_line(const float &x, const float &y, const float &z, const floa
 
   // Mark block as not busy (Not executed by the stepper interrupt)
   block->busy = false;
+#ifdef PRINT_PROGRESS
+  block->estimated_time = 0; // Not in planned_time yet
+#endif
 
   // Number of steps for each axis
 #ifndef COREXY
@@ -666,15 +1004,45 @@ block->steps_y = labs((target[X_AXIS]-position[X_AXIS]) - (target[Y_AXIS]-positi
   }
 
   float delta_mm[4];
+#ifdef FIXED_POINT_PLANNER
+  // The step counts as 16 bit mantissas and exponents, and the lengths of the axes from them
+  unsigned long axis_steps[4];
+  axis_steps[X_AXIS] = block->steps_x;
+  axis_steps[Y_AXIS] = block->steps_y;
+  axis_steps[Z_AXIS] = block->steps_z;
+  axis_steps[E_AXIS] = block->steps_e;
+  unsigned short steps[4];
+  int8_t steps_shift[4];
+  unsigned long length[4];
+  int8_t length_exponent[4];
+  for(unsigned char i=0; i < 4; i++)
+  {
+    steps_shift[i] = 0;
+    while ((axis_steps[i] >> steps_shift[i]) > 0xFFFF) steps_shift[i]++;
+    steps[i] = axis_steps[i] >> steps_shift[i];
+    length[i] = (unsigned long)steps[i] * length_per_step[i];
+    length_exponent[i] = steps_shift[i] - length_unit_shift[i];
+    delta_mm[i] = ldexp(length[i], length_exponent[i]);
+    if (block->direction_bits & (1<<i)) delta_mm[i] = -delta_mm[i];
+  }
+  if ( block->steps_x <=dropsegments && block->steps_y <=dropsegments && block->steps_z <=dropsegments )
+  {
+    block->millimeters = fabs(delta_mm[E_AXIS]);
+  }
+  else
+  {
+    block->millimeters = fixed_length(length, length_exponent, 3);
+  }
+#else
   #ifndef COREXY
-    delta_mm[X_AXIS] = (target[X_AXIS]-position[X_AXIS])/axis_steps_per_unit[X_AXIS];
-    delta_mm[Y_AXIS] = (target[Y_AXIS]-position[Y_AXIS])/axis_steps_per_unit[Y_AXIS];
+    delta_mm[X_AXIS] = (target[X_AXIS]-position[X_AXIS])*axis_mm_per_step[X_AXIS];
+    delta_mm[Y_AXIS] = (target[Y_AXIS]-position[Y_AXIS])*axis_mm_per_step[Y_AXIS];
   #else
-    delta_mm[X_AXIS] = ((target[X_AXIS]-position[X_AXIS]) + (target[Y_AXIS]-position[Y_AXIS]))/axis_steps_per_unit[X_AXIS];
-    delta_mm[Y_AXIS] = ((target[X_AXIS]-position[X_AXIS]) - (target[Y_AXIS]-position[Y_AXIS]))/axis_steps_per_unit[Y_AXIS];
+    delta_mm[X_AXIS] = ((target[X_AXIS]-position[X_AXIS]) + (target[Y_AXIS]-position[Y_AXIS]))*axis_mm_per_step[X_AXIS];
+    delta_mm[Y_AXIS] = ((target[X_AXIS]-position[X_AXIS]) - (target[Y_AXIS]-position[Y_AXIS]))*axis_mm_per_step[Y_AXIS];
   #endif
-  delta_mm[Z_AXIS] = (target[Z_AXIS]-position[Z_AXIS])/axis_steps_per_unit[Z_AXIS];
-  delta_mm[E_AXIS] = ((target[E_AXIS]-position[E_AXIS])/axis_steps_per_unit[E_AXIS])*extrudemultiply/100.0;
+  delta_mm[Z_AXIS] = (target[Z_AXIS]-position[Z_AXIS])*axis_mm_per_step[Z_AXIS];
+  delta_mm[E_AXIS] = (target[E_AXIS]-position[E_AXIS])*axis_mm_per_step[E_AXIS]*extrudemultiply*0.01;
   if ( block->steps_x <=dropsegments && block->steps_y <=dropsegments && block->steps_z <=dropsegments )
   {
     block->millimeters = fabs(delta_mm[E_AXIS]);
@@ -683,8 +1051,16 @@ block->steps_y = labs((target[X_AXIS]-position[X_AXIS]) - (target[Y_AXIS]-positi
   {
     block->millimeters = sqrt(square(delta_mm[X_AXIS]) + square(delta_mm[Y_AXIS]) + square(delta_mm[Z_AXIS]));
   }
+#endif // FIXED_POINT_PLANNER
 
   #ifdef LASER
+    #ifdef VAT_EXPOSURE_COMPENSATION
+    // The vat temperature only matters per layer, take it when Z moves
+    if (target[Z_AXIS] != position[Z_AXIS]) vat_exposure_update();
+    if (vat_exposure_mode == VAT_EXPOSURE_INTENSITY)
+      block->laser_intensity = calc_laser_intensity(laser.intensity * vat_exposure_factor);
+    else
+    #endif
     block->laser_intensity = calc_laser_intensity(laser.intensity);
     block->laser_duration = laser.duration;
     block->laser_status = laser.status;
@@ -699,10 +1075,21 @@ block->steps_y = labs((target[X_AXIS]-position[X_AXIS]) - (target[Y_AXIS]-positi
     #endif
   #endif // LASER
 
+  #ifdef VAT_EXPOSURE_COMPENSATION
+    // Less exposure is needed in a warm vat, so the lasing moves get faster
+    if (vat_exposure_mode == VAT_EXPOSURE_FEEDRATE && block->laser_status == LASER_ON)
+      feed_rate /= vat_exposure_factor;
+  #endif
+
   float inverse_millimeters = 1.0/block->millimeters;  // Inverse millimeters to remove multiple divides
 
     // Calculate speed in mm/second for each axis. No divide by zero due to previous checks.
   float inverse_second = feed_rate * inverse_millimeters;
+#ifdef LIVE_FEEDRATE_OVERRIDE
+  // The override changed while waiting for room in the buffer
+  if (block->steps_x != 0 || block->steps_y != 0)
+    inverse_second *= (float)planned_feedmultiply / queued_feedmultiply;
+#endif
 
   int moves_queued=(block_buffer_head-block_buffer_tail + BLOCK_BUFFER_SIZE) & (BLOCK_BUFFER_SIZE - 1);
 
@@ -735,12 +1122,43 @@ block->steps_y = labs((target[X_AXIS]-position[X_AXIS]) - (target[Y_AXIS]-positi
   // Calculate and limit speed in mm/sec for each axis
   float current_speed[4];
   float speed_factor = 1.0; //factor <=1 do decrease speed
-  for(int i=0; i < 4; i++)
+  // Only the axis that runs closest to its max rate can limit the speed. Find it with multiplies and divide once.
+  unsigned char limit_axis = X_AXIS;
+  float limit_axis_rate, limit_axis_max_rate;
+#ifdef FIXED_POINT_PLANNER
+  for(unsigned char i=1; i < 4; i++)
+  {
+    if(scaled_greater((unsigned long)steps[i] * max_step_rate[limit_axis], steps_shift[i],
+                      (unsigned long)steps[limit_axis] * max_step_rate[i], steps_shift[limit_axis]))
+      limit_axis = i;
+  }
+  limit_axis_rate = axis_steps[limit_axis] * inverse_second;
+  limit_axis_max_rate = ldexp(max_step_rate[limit_axis], max_step_rate_shift);
+  for(unsigned char i=0; i < 4; i++)
+    current_speed[i] = delta_mm[i] * inverse_second;
+#else
+  for(unsigned char i=0; i < 4; i++)
   {
     current_speed[i] = delta_mm[i] * inverse_second;
-    if(fabs(current_speed[i]) > max_feedrate[i])
-      speed_factor = min(speed_factor, max_feedrate[i] / fabs(current_speed[i]));
+    if(fabs(current_speed[i]) * max_feedrate[limit_axis] > fabs(current_speed[limit_axis]) * max_feedrate[i])
+      limit_axis = i;
   }
+  limit_axis_rate = fabs(current_speed[limit_axis]);
+  limit_axis_max_rate = max_feedrate[limit_axis];
+#endif // FIXED_POINT_PLANNER
+#ifdef LIVE_FEEDRATE_OVERRIDE
+  float max_speed_factor = limit_axis_max_rate / limit_axis_rate;
+  if(max_speed_factor < 1.0)
+    speed_factor = max_speed_factor;
+#else
+  if(limit_axis_rate > limit_axis_max_rate)
+    speed_factor = limit_axis_max_rate / limit_axis_rate;
+#endif
+#ifdef LIVE_FEEDRATE_OVERRIDE
+  block->requested_speed = block->nominal_speed;
+  block->max_nominal_speed = block->nominal_speed * max_speed_factor;
+  block->nominal_changed = false;
+#endif
 
   // Max segement time in us.
 #ifdef XY_FREQUENCY_LIMIT
@@ -789,92 +1207,132 @@ block->steps_y = labs((target[X_AXIS]-position[X_AXIS]) - (target[Y_AXIS]-positi
   }
 
   // Compute and limit the acceleration rate for the trapezoid generator.
-  float steps_per_mm = block->step_event_count/block->millimeters;
+  float steps_per_mm = block->step_event_count * inverse_millimeters;
   if(block->steps_x == 0 && block->steps_y == 0 && block->steps_z == 0)
-  {
-    block->acceleration_st = ceil(retract_acceleration * steps_per_mm); // convert to: acceleration steps/sec^2
-  }
+    block->acceleration = retract_acceleration;
   else
+    block->acceleration = acceleration;
+  block->acceleration_st = ceil(block->acceleration * steps_per_mm); // convert to: acceleration steps/sec^2
+  if(block->steps_x != 0 || block->steps_y != 0 || block->steps_z != 0)
   {
-    block->acceleration_st = ceil(acceleration * steps_per_mm); // convert to: acceleration steps/sec^2
-    // Limit acceleration per axis
-    if(((float)block->acceleration_st * (float)block->steps_x / (float)block->step_event_count) > axis_steps_per_sqr_second[X_AXIS])
+    // Limit acceleration per axis. Only the axes with a max acceleration not above the acceleration can limit it,
+    // and only a limited acceleration needs a divide to go back to mm/sec^2.
+    unsigned long acceleration_st = block->acceleration_st;
+#ifdef FIXED_POINT_PLANNER
+    int8_t step_events_shift = 0;
+    while ((block->step_event_count >> step_events_shift) > 0xFFFF) step_events_shift++;
+    unsigned short step_events = block->step_event_count >> step_events_shift;
+    #define AXIS_ACCELERATION_EXCEEDED(axis) axis_acceleration_exceeded(block->acceleration_st, steps[axis], steps_shift[axis] - step_events_shift, step_events, axis_steps_per_sqr_second[axis])
+#else
+    float step_event_count = block->step_event_count;
+    #define AXIS_ACCELERATION_EXCEEDED(axis) ((float)block->acceleration_st * (float)axis_steps[axis] > axis_steps_per_sqr_second[axis] * step_event_count)
+    unsigned long axis_steps[4];
+    axis_steps[X_AXIS] = block->steps_x;
+    axis_steps[Y_AXIS] = block->steps_y;
+    axis_steps[Z_AXIS] = block->steps_z;
+    axis_steps[E_AXIS] = block->steps_e;
+#endif
+    if((acceleration_limited_axes & (1<<X_AXIS)) && AXIS_ACCELERATION_EXCEEDED(X_AXIS))
       block->acceleration_st = axis_steps_per_sqr_second[X_AXIS];
-    if(((float)block->acceleration_st * (float)block->steps_y / (float)block->step_event_count) > axis_steps_per_sqr_second[Y_AXIS])
+    if((acceleration_limited_axes & (1<<Y_AXIS)) && AXIS_ACCELERATION_EXCEEDED(Y_AXIS))
       block->acceleration_st = axis_steps_per_sqr_second[Y_AXIS];
-    if(((float)block->acceleration_st * (float)block->steps_e / (float)block->step_event_count) > axis_steps_per_sqr_second[E_AXIS])
+    if((acceleration_limited_axes & (1<<E_AXIS)) && AXIS_ACCELERATION_EXCEEDED(E_AXIS))
       block->acceleration_st = axis_steps_per_sqr_second[E_AXIS];
-    if(((float)block->acceleration_st * (float)block->steps_z / (float)block->step_event_count ) > axis_steps_per_sqr_second[Z_AXIS])
+    if((acceleration_limited_axes & (1<<Z_AXIS)) && AXIS_ACCELERATION_EXCEEDED(Z_AXIS))
       block->acceleration_st = axis_steps_per_sqr_second[Z_AXIS];
+    #undef AXIS_ACCELERATION_EXCEEDED
+    if(block->acceleration_st != acceleration_st)
+      block->acceleration = block->acceleration_st / steps_per_mm;
   }
-  block->acceleration = block->acceleration_st / steps_per_mm;
+#ifdef FIXED_POINT_PLANNER
+  // acceleration_st * 2^24 / (F_CPU/8), with the integer and the 16 bit fraction part of the factor
+  block->acceleration_rate = block->acceleration_st * ACCELERATION_RATE_INT
+    + (block->acceleration_st >> 16) * ACCELERATION_RATE_FRACTION
+    + (((unsigned long)(unsigned short)block->acceleration_st * ACCELERATION_RATE_FRACTION) >> 16);
+#else
   block->acceleration_rate = (long)((float)block->acceleration_st * (16777216.0 / (F_CPU / 8.0)));
+#endif
+  #ifdef LASER_CONSTANT_ENERGY
+    block->laser_ramp_factor = calc_laser_ramp_factor(block->laser_intensity, block->nominal_rate, block->laser_ramp_shift);
+  #endif
 
-#if 0  // Use old jerk for now
-  // Compute path unit vector
-  double unit_vec[3];
-
-  unit_vec[X_AXIS] = delta_mm[X_AXIS]*inverse_millimeters;
-  unit_vec[Y_AXIS] = delta_mm[Y_AXIS]*inverse_millimeters;
-  unit_vec[Z_AXIS] = delta_mm[Z_AXIS]*inverse_millimeters;
-
-  // Compute maximum allowable entry speed at junction by centripetal acceleration approximation.
-  // Let a circle be tangent to both previous and current path line segments, where the junction
-  // deviation is defined as the distance from the junction to the closest edge of the circle,
-  // colinear with the circle center. The circular segment joining the two paths represents the
-  // path of centripetal acceleration. Solve for max velocity based on max acceleration about the
-  // radius of the circle, defined indirectly by junction deviation. This may be also viewed as
-  // path width or max_jerk in the previous grbl version. This approach does not actually deviate
-  // from path, but used as a robust way to compute cornering speeds, as it takes into account the
-  // nonlinearities of both the junction angle and junction velocity.
-  double vmax_junction = MINIMUM_PLANNER_SPEED; // Set default max junction speed
-
-  // Skip first block or when previous_nominal_speed is used as a flag for homing and offset cycles.
-  if ((block_buffer_head != block_buffer_tail) && (previous_nominal_speed > 0.0)) {
-    // Compute cosine of angle between previous and current path. (prev_unit_vec is negative)
-    // NOTE: Max junction velocity is computed without sin() or acos() by trig half angle identity.
-    double cos_theta = - previous_unit_vec[X_AXIS] * unit_vec[X_AXIS]
-      - previous_unit_vec[Y_AXIS] * unit_vec[Y_AXIS]
-      - previous_unit_vec[Z_AXIS] * unit_vec[Z_AXIS] ;
-
-    // Skip and use default max junction speed for 0 degree acute junction.
-    if (cos_theta < 0.95) {
-      vmax_junction = min(previous_nominal_speed,block->nominal_speed);
-      // Skip and avoid divide by zero for straight junctions at 180 degrees. Limit to min() of nominal speeds.
-      if (cos_theta > -0.95) {
-        // Compute maximum junction velocity based on maximum acceleration and junction deviation
-        double sin_theta_d2 = sqrt(0.5*(1.0-cos_theta)); // Trig half angle identity. Always positive.
-        vmax_junction = min(vmax_junction,
-        sqrt(block->acceleration * junction_deviation * sin_theta_d2/(1.0-sin_theta_d2)) );
+  float vmax_junction;
+  float safe_speed;
+#ifdef JUNCTION_DEVIATION
+  // Compute path unit vector. E is included, it is the second Z motor on the mUVe 1.
+  float unit_vec[4];
+#ifdef FIXED_POINT_PLANNER
+  float inverse_length = 1.0/fixed_length(length, length_exponent, 4);
+#else
+  float inverse_length = 1.0/sqrt(square(delta_mm[X_AXIS]) + square(delta_mm[Y_AXIS]) + square(delta_mm[Z_AXIS]) + square(delta_mm[E_AXIS]));
+#endif
+  for(unsigned char i=0; i < 4; i++)
+    unit_vec[i] = delta_mm[i]*inverse_length;
+
+  if (junction_deviation > 0.0) {
+    // Compute maximum allowable entry speed at junction by centripetal acceleration approximation.
+    // Let a circle be tangent to both previous and current path line segments, where the junction
+    // deviation is defined as the distance from the junction to the closest edge of the circle,
+    // colinear with the circle center. The circular segment joining the two paths represents the
+    // path of centripetal acceleration. Solve for max velocity based on max acceleration about the
+    // radius of the circle, defined indirectly by junction deviation. This may be also viewed as
+    // path width or max_jerk in the previous grbl version. This approach does not actually deviate
+    // from path, but used as a robust way to compute cornering speeds, as it takes into account the
+    // nonlinearities of both the junction angle and junction velocity.
+    vmax_junction = MINIMUM_PLANNER_SPEED; // Set default max junction speed
+
+    // Skip first block or when previous_nominal_speed is used as a flag for homing and offset cycles.
+    if ((moves_queued > 1) && (previous_nominal_speed > 0.0001)) {
+      // Compute cosine of angle between previous and current path. (prev_unit_vec is negative)
+      // NOTE: Max junction velocity is computed without sin() or acos() by trig half angle identity.
+      float cos_theta = - previous_unit_vec[X_AXIS] * unit_vec[X_AXIS]
+        - previous_unit_vec[Y_AXIS] * unit_vec[Y_AXIS]
+        - previous_unit_vec[Z_AXIS] * unit_vec[Z_AXIS]
+        - previous_unit_vec[E_AXIS] * unit_vec[E_AXIS];
+
+      // Skip and use default max junction speed for 0 degree acute junction.
+      if (cos_theta < 0.95) {
+        vmax_junction = min(previous_nominal_speed,block->nominal_speed);
+        // Skip and avoid divide by zero for straight junctions at 180 degrees. Limit to min() of nominal speeds.
+        if (cos_theta > -0.95) {
+          // Compute maximum junction velocity based on maximum acceleration and junction deviation
+          float sin_theta_d2 = sqrt(0.5*(1.0-cos_theta)); // Trig half angle identity. Always positive.
+          vmax_junction = min(vmax_junction,
+          sqrt(block->acceleration * junction_deviation * sin_theta_d2/(1.0-sin_theta_d2)) );
+        }
       }
     }
+    safe_speed = MINIMUM_PLANNER_SPEED;
   }
-#endif
-  // Start with a safe speed
-  float vmax_junction = max_xy_jerk/2;
-  float vmax_junction_factor = 1.0;
-  if(fabs(current_speed[Z_AXIS]) > max_z_jerk/2)
-    vmax_junction = min(vmax_junction, max_z_jerk/2);
-  if(fabs(current_speed[E_AXIS]) > max_e_jerk/2)
-    vmax_junction = min(vmax_junction, max_e_jerk/2);
-  vmax_junction = min(vmax_junction, block->nominal_speed);
-  float safe_speed = vmax_junction;
-
-  if ((moves_queued > 1) && (previous_nominal_speed > 0.0001)) {
-    float jerk = sqrt(pow((current_speed[X_AXIS]-previous_speed[X_AXIS]), 2)+pow((current_speed[Y_AXIS]-previous_speed[Y_AXIS]), 2));
-    //    if((fabs(previous_speed[X_AXIS]) > 0.0001) || (fabs(previous_speed[Y_AXIS]) > 0.0001)) {
-    vmax_junction = block->nominal_speed;
-    //    }
-    if (jerk > max_xy_jerk) {
-      vmax_junction_factor = (max_xy_jerk/jerk);
-    }
-    if(fabs(current_speed[Z_AXIS] - previous_speed[Z_AXIS]) > max_z_jerk) {
-      vmax_junction_factor= min(vmax_junction_factor, (max_z_jerk/fabs(current_speed[Z_AXIS] - previous_speed[Z_AXIS])));
-    }
-    if(fabs(current_speed[E_AXIS] - previous_speed[E_AXIS]) > max_e_jerk) {
-      vmax_junction_factor = min(vmax_junction_factor, (max_e_jerk/fabs(current_speed[E_AXIS] - previous_speed[E_AXIS])));
+  else
+#endif // JUNCTION_DEVIATION
+  {
+    // Start with a safe speed
+    vmax_junction = max_xy_jerk/2;
+    float vmax_junction_factor = 1.0;
+    if(fabs(current_speed[Z_AXIS]) > max_z_jerk/2)
+      vmax_junction = min(vmax_junction, max_z_jerk/2);
+    if(fabs(current_speed[E_AXIS]) > max_e_jerk/2)
+      vmax_junction = min(vmax_junction, max_e_jerk/2);
+    vmax_junction = min(vmax_junction, block->nominal_speed);
+    safe_speed = vmax_junction;
+
+    if ((moves_queued > 1) && (previous_nominal_speed > 0.0001)) {
+      float jerk = sqrt(pow((current_speed[X_AXIS]-previous_speed[X_AXIS]), 2)+pow((current_speed[Y_AXIS]-previous_speed[Y_AXIS]), 2));
+      //    if((fabs(previous_speed[X_AXIS]) > 0.0001) || (fabs(previous_speed[Y_AXIS]) > 0.0001)) {
+      vmax_junction = block->nominal_speed;
+      //    }
+      if (jerk > max_xy_jerk) {
+        vmax_junction_factor = (max_xy_jerk/jerk);
+      }
+      if(fabs(current_speed[Z_AXIS] - previous_speed[Z_AXIS]) > max_z_jerk) {
+        vmax_junction_factor= min(vmax_junction_factor, (max_z_jerk/fabs(current_speed[Z_AXIS] - previous_speed[Z_AXIS])));
+      }
+      if(fabs(current_speed[E_AXIS] - previous_speed[E_AXIS]) > max_e_jerk) {
+        vmax_junction_factor = min(vmax_junction_factor, (max_e_jerk/fabs(current_speed[E_AXIS] - previous_speed[E_AXIS])));
+      }
+      vmax_junction = min(previous_nominal_speed, vmax_junction * vmax_junction_factor); // Limit speed to max previous speed
     }
-    vmax_junction = min(previous_nominal_speed, vmax_junction * vmax_junction_factor); // Limit speed to max previous speed
   }
   block->max_entry_speed = vmax_junction;
 
@@ -901,6 +1359,9 @@ block->steps_y = labs((target[X_AXIS]-position[X_AXIS]) - (target[Y_AXIS]-positi
   // Update previous path unit_vector and nominal speed
   memcpy(previous_speed, current_speed, sizeof(previous_speed)); // previous_speed[] = current_speed[]
   previous_nominal_speed = block->nominal_speed;
+#ifdef JUNCTION_DEVIATION
+  memcpy(previous_unit_vec, unit_vec, sizeof(previous_unit_vec)); // previous_unit_vec[] = unit_vec[]
+#endif
 
 
 #ifdef ADVANCE
@@ -930,6 +1391,13 @@ block->steps_y = labs((target[X_AXIS]-position[X_AXIS]) - (target[Y_AXIS]-positi
    */
 #endif // ADVANCE
 
+  // The steps per interrupt at the nominal rate are picked once, here. They follow the previous block with
+  // hysteresis, so blocks with rates around a switch point all get the same. A feedrate override that rescales
+  // the nominal rate later (LIVE_FEEDRATE_OVERRIDE) works out a new nominal_timer for the same loops.
+  block->nominal_loops = previous_nominal_loops;
+  block->nominal_timer = calc_step_timer(block->nominal_rate, block->nominal_loops);
+  previous_nominal_loops = block->nominal_loops;
+
   calculate_trapezoid_for_block(block, block->entry_speed/block->nominal_speed,
   safe_speed/block->nominal_speed);
 
@@ -938,6 +1406,10 @@ block->steps_y = labs((target[X_AXIS]-position[X_AXIS]) - (target[Y_AXIS]-positi
 
   // Update position
   memcpy(position, target, sizeof(target)); // position[] = target[]
+  #ifdef PLATE_TILT_COMPENSATION
+  memcpy(plate_tilt_logical, tilt_logical, sizeof(tilt_logical));
+  plate_tilt_known = true;
+  #endif
 
   planner_recalculate();
 
@@ -950,6 +1422,19 @@ void plan_set_position(const float &x, const float &y, const float &z, const flo
   position[Y_AXIS] = lround(y*axis_steps_per_unit[Y_AXIS]);
   position[Z_AXIS] = lround(z*axis_steps_per_unit[Z_AXIS]);
   position[E_AXIS] = lround(e*axis_steps_per_unit[E_AXIS]);
+  #ifdef XY_CORRECTION
+  if(xy_correction_active)
+    xy_correct(position);
+  #endif
+  #ifdef PLATE_TILT_COMPENSATION
+  for(uint8_t m=0; m < PLATE_TILT_MOTORS; m++)
+  {
+    plate_tilt_logical[m] = position[plate_tilt_axis[m]];
+    if(plate_tilt_active)
+      position[plate_tilt_axis[m]] -= plate_tilt_offset[m];
+  }
+  plate_tilt_known = true;
+  #endif
   st_set_position(position[X_AXIS], position[Y_AXIS], position[Z_AXIS], position[E_AXIS]);
   previous_nominal_speed = 0.0; // Resets planner junction speeds. Assumes start from rest.
   previous_speed[0] = 0.0;
@@ -962,6 +1447,26 @@ void plan_set_e_position(const float &e)
 {
   position[E_AXIS] = lround(e*axis_steps_per_unit[E_AXIS]);
   st_set_e_position(position[E_AXIS]);
+  #if defined(PLATE_TILT_COMPENSATION) && PLATE_TILT_MOTORS > 1
+  plate_tilt_known = false;
+  #endif
+}
+
+void plan_sync_position()
+{
+  #ifdef PLATE_TILT_COMPENSATION
+  // A Z motor stopped short of its target, e.g. by an endstop
+  for(uint8_t m=0; m < PLATE_TILT_MOTORS; m++)
+    if(st_get_position(plate_tilt_axis[m]) != position[plate_tilt_axis[m]])
+      plate_tilt_known = false;
+  #endif
+  for(int8_t i=0; i < NUM_AXIS; i++)
+    position[i] = st_get_position(i);
+  previous_nominal_speed = 0.0;
+  previous_speed[0] = 0.0;
+  previous_speed[1] = 0.0;
+  previous_speed[2] = 0.0;
+  previous_speed[3] = 0.0;
 }
 
 uint8_t movesplanned()
@@ -969,6 +1474,17 @@ uint8_t movesplanned()
   return (block_buffer_head-block_buffer_tail + BLOCK_BUFFER_SIZE) & (BLOCK_BUFFER_SIZE - 1);
 }
 
+#ifdef PRINT_PROGRESS
+// The block the stepper is on counts whole
+float plan_queued_time()
+{
+  float time = 0;
+  for (int8_t block_index = block_buffer_tail; block_index != block_buffer_head; block_index = next_block_index(block_index))
+    time += block_buffer[block_index].estimated_time;
+  return time;
+}
+#endif
+
 #ifdef PREVENT_DANGEROUS_EXTRUDE
 void set_extrude_min_temp(float temp)
 {
@@ -976,11 +1492,111 @@ void set_extrude_min_temp(float temp)
 }
 #endif
 
-// Calculate the steps/s^2 acceleration rates, based on the mm/s^s
+#ifdef FIXED_POINT_PLANNER
+// Work out the step constants of the fixed point planner
+static void reset_fixed_point_constants()
+{
+  float max_rate = 0;
+  for(int8_t i=0; i < NUM_AXIS; i++)
+    max_rate = max(max_rate, max_feedrate[i] * axis_steps_per_unit[i]);
+  max_step_rate_shift = 0;
+  while(ldexp(max_rate, -max_step_rate_shift) > 65535)
+    max_step_rate_shift++;
+  for(int8_t i=0; i < NUM_AXIS; i++)
+  {
+    int exponent;
+    long mantissa = lround(ldexp(frexp(axis_mm_per_step[i], &exponent), 16));
+    if(mantissa > 0xFFFF)
+    {
+      mantissa >>= 1;
+      exponent++;
+    }
+    length_per_step[i] = mantissa;
+    length_unit_shift[i] = 16 - exponent;
+    max_step_rate[i] = min(lround(ldexp(max_feedrate[i] * axis_steps_per_unit[i], -max_step_rate_shift)), 65535L);
+  }
+}
+#endif
+
+// Calculate the steps/s^2 acceleration rates, based on the mm/s^s, and the other per axis constants of
+// plan_buffer_line(). Call it after every change of the steps per unit, max feedrates or accelerations.
 void reset_acceleration_rates()
 {
+	acceleration_limited_axes = 0;
 	for(int8_t i=0; i < NUM_AXIS; i++)
         {
         axis_steps_per_sqr_second[i] = max_acceleration_units_per_sq_second[i] * axis_steps_per_unit[i];
+        axis_mm_per_step[i] = 1.0 / axis_steps_per_unit[i];
+        if(axis_steps_per_sqr_second[i] < acceleration * axis_steps_per_unit[i] + 2) // +2 for the rounding of both
+          acceleration_limited_axes |= (1<<i);
         }
+	// The test above takes an axis' share of the move as at most its own mm. E is not part of the
+	// millimeters of a move with XYZ travel, so it can have the larger share, and a CoreXY motor
+	// turns up to sqrt(2) times the mm of the move. Those are always checked.
+	acceleration_limited_axes |= (1<<E_AXIS);
+#ifdef COREXY
+	acceleration_limited_axes |= (1<<X_AXIS) | (1<<Y_AXIS);
+#endif
+#ifdef FIXED_POINT_PLANNER
+	reset_fixed_point_constants();
+#endif
+#ifdef XY_CORRECTION
+	reset_xy_correction();
+#endif
+#ifdef PLATE_TILT_COMPENSATION
+	reset_plate_tilt();
+#endif
+}
+
+#ifdef XY_CORRECTION
+// Work out the map in steps, after a change of the map or of the steps per unit
+void reset_xy_correction()
+{
+  const float corner[2][2] = { { XY_CORRECTION_MIN_X, XY_CORRECTION_MAX_X }, { XY_CORRECTION_MIN_Y, XY_CORRECTION_MAX_Y } };
+  const uint8_t cells[2] = { XY_CORRECTION_POINTS_X - 1, XY_CORRECTION_POINTS_Y - 1 };
+  for(uint8_t axis=X_AXIS; axis <= Y_AXIS; axis++)
+  {
+    xy_correction_origin[axis] = lround(corner[axis][0] * axis_steps_per_unit[axis]);
+    xy_correction_span[axis] = max(lround(corner[axis][1] * axis_steps_per_unit[axis]) - xy_correction_origin[axis], 1);
+    xy_correction_scale[axis] = ((unsigned long)cells[axis] << 24) / xy_correction_span[axis];
+  }
+  xy_correction_active = false;
+  for(uint8_t j=0; j < XY_CORRECTION_POINTS_Y; j++)
+    for(uint8_t i=0; i < XY_CORRECTION_POINTS_X; i++)
+      for(uint8_t axis=X_AXIS; axis <= Y_AXIS; axis++)
+      {
+        xy_correction_steps[j][i][axis] = lround(xy_correction[j][i][axis] * axis_steps_per_unit[axis] / 1000.0);
+        if(xy_correction_steps[j][i][axis] != 0)
+          xy_correction_active = true;
+      }
+}
+#endif // XY_CORRECTION
+
+#ifdef PLATE_TILT_COMPENSATION
+// Work out the plane in steps, after a change of the points or of the steps per unit. The Z row of the
+// leveling rotation matrix is the plane normal, it gives the plate height as Z = offset - (X * m[2] + Y * m[5]) / m[8].
+void reset_plate_tilt()
+{
+  plate_tilt_active = false;
+  if(plate_tilt[0][Z_AXIS] == 0 && plate_tilt[1][Z_AXIS] == 0 && plate_tilt[2][Z_AXIS] == 0)
+    return;
+  vector_3 pt1 = vector_3(plate_tilt[0][X_AXIS], plate_tilt[0][Y_AXIS], plate_tilt[0][Z_AXIS]);
+  vector_3 pt2 = vector_3(plate_tilt[1][X_AXIS], plate_tilt[1][Y_AXIS], plate_tilt[1][Z_AXIS]);
+  vector_3 pt3 = vector_3(plate_tilt[2][X_AXIS], plate_tilt[2][Y_AXIS], plate_tilt[2][Z_AXIS]);
+  vector_3 normal = vector_3::cross(pt2 - pt1, pt3 - pt1);
+  if(normal.get_length() < 1.0) // the points are (nearly) on a line
+    return;
+  if(normal.z < 0)
+    normal = vector_3(-normal.x, -normal.y, -normal.z);
+  matrix_3x3 level = matrix_3x3::create_look_at(vector_3(-normal.x, -normal.y, -normal.z), vector_3(1, 0, 0));
+  float slope[2] = { -level.matrix[2] / level.matrix[8], -level.matrix[5] / level.matrix[8] }; // mm of Z per mm of X and Y
+  float offset = pt1.z - slope[0] * pt1.x - slope[1] * pt1.y;
+
+  // The plane at the motors, they hold the plate at fixed points so each one only needs an offset
+  const float motor_pos[2][2] = PLATE_TILT_MOTOR_POS;
+  for(uint8_t m=0; m < PLATE_TILT_MOTORS; m++)
+    plate_tilt_offset[m] = lround((offset + slope[0] * motor_pos[m][X_AXIS] + slope[1] * motor_pos[m][Y_AXIS])
+                                  * axis_steps_per_unit[plate_tilt_axis[m]]);
+  plate_tilt_active = true;
 }
+#endif // PLATE_TILT_COMPENSATION
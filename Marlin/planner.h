@@ -39,6 +39,15 @@ typedef struct {
   long accelerate_until;                    // The index of the step event on which to stop acceleration
   long decelerate_after;                    // The index of the step event on which to start decelerating
   long acceleration_rate;                   // The acceleration rate used for acceleration calculation
+  #ifdef S_CURVE_ACCELERATION
+    unsigned long cruise_rate;              // The step rate at the end of the acceleration
+    unsigned long acceleration_ticks;       // Duration of the ramps in timer ticks
+    unsigned long deceleration_ticks;
+    unsigned long acceleration_inverse;     // 0xFFFFFFFF / (ticks >> shift), to find the position on the ramp
+    unsigned long deceleration_inverse;
+    unsigned char acceleration_shift;       // Brings the ticks down to 16 bits
+    unsigned char deceleration_shift;
+  #endif
   unsigned char direction_bits;             // The direction bit set for this block (refers to *_DIRECTION_BIT in config.h)
   unsigned char active_extruder;            // Selects the active extruder
   #ifdef ADVANCE
@@ -57,12 +66,24 @@ typedef struct {
   float acceleration;                                // acceleration mm/sec^2
   unsigned char recalculate_flag;                    // Planner flag to recalculate trapezoids on entry junction
   unsigned char nominal_length_flag;                 // Planner flag for nominal speed always reached
+  #ifdef LIVE_FEEDRATE_OVERRIDE
+    float requested_speed;                           // The speed asked for, nominal_speed is this within max_nominal_speed
+    float max_nominal_speed;                         // The highest speed within max_feedrate
+    unsigned char nominal_changed;                   // nominal_speed was rescaled, the stepper still has the old rate
+  #endif
 
   // Settings for the trapezoid generator
   unsigned long nominal_rate;                        // The nominal step rate for this block in step_events/sec
   unsigned long initial_rate;                        // The jerk-adjusted step rate at start of block
   unsigned long final_rate;                          // The minimal rate at exit
+  unsigned short initial_timer;                      // Timer interval and steps per interrupt for the
+  unsigned short nominal_timer;                      // initial and nominal rates, see calc_step_timer()
+  unsigned char initial_loops;
+  unsigned char nominal_loops;
   unsigned long acceleration_st;                     // acceleration steps/sec^2
+  #ifdef PRINT_PROGRESS
+    float estimated_time;                            // (s) of the trapezoid, counted in planned_time
+  #endif
   unsigned long fan_speed;
   #ifdef BARICUDA
     unsigned long valve_pressure;
@@ -74,6 +95,10 @@ typedef struct {
     unsigned long laser_duration; // laser firing duration in microseconds, for pulsed firing mode
     long steps_l; // step count between firings of the laser, for pulsed firing mode
     unsigned long laser_intensity; // Laser firing instensity in PWM ticks
+    #ifdef LASER_CONSTANT_ENERGY
+      unsigned long laser_ramp_factor; // (step_rate << laser_ramp_shift) * laser_ramp_factor >> 24 is the duty cycle during the ramps
+      unsigned char laser_ramp_shift;
+    #endif
   #endif // LASER
   volatile char busy;
 } block_t;
@@ -85,10 +110,18 @@ void plan_init();
 // millimaters. Feed rate specifies the speed of the motion.
 void plan_buffer_line(const float &x, const float &y, const float &z, const float &e, float feed_rate, const uint8_t &extruder);
 
+#ifdef LIVE_FEEDRATE_OVERRIDE
+// Rescale the queued moves after a change of feedmultiply
+void plan_apply_feedmultiply();
+#endif
+
 // Set position. Used for G92 instructions.
 void plan_set_position(const float &x, const float &y, const float &z, const float &e);
 void plan_set_e_position(const float &e);
 
+// Take the position in steps from the steppers, after a move that an endstop cut short
+void plan_sync_position();
+
 
 
 void check_axes_activity();
@@ -104,6 +137,9 @@ extern float retract_acceleration; //  mm/s^2   filament pull-pack and push-forw
 extern float max_xy_jerk; //speed than can be stopped at once, if i understand correctly.
 extern float max_z_jerk;
 extern float max_e_jerk;
+#ifdef JUNCTION_DEVIATION
+extern float junction_deviation; // mm, 0 = use the jerk limits
+#endif
 extern float mintravelfeedrate;
 extern unsigned long axis_steps_per_sqr_second[NUM_AXIS];
 
@@ -155,4 +191,26 @@ void set_extrude_min_temp(float temp);
 #endif
 
 void reset_acceleration_rates();
+
+#ifdef PRINT_PROGRESS
+// Estimated time (s) of the moves planned since the start of the layer, trapezoids that are planned again update
+// it. print_progress_layer() and print_progress_start() set it back to 0, so a long print keeps its precision.
+extern float planned_time;
+// Estimated time (s) of the moves still in the buffer
+float plan_queued_time();
+#endif
+
+#ifdef XY_CORRECTION
+// Position error of the machine in microns at each point of the map, [row][column][axis], see M655
+extern int xy_correction[XY_CORRECTION_POINTS_Y][XY_CORRECTION_POINTS_X][2];
+extern bool xy_correction_active; // the map is not all 0
+void reset_xy_correction();
+#endif
+
+#ifdef PLATE_TILT_COMPENSATION
+// X, Y and the height error of the build plate (mm) at three points, see M656
+extern float plate_tilt[3][3];
+extern bool plate_tilt_active; // some point has an error
+void reset_plate_tilt();
+#endif
 #endif
@@ -0,0 +1,136 @@
+#!/usr/bin/env python
+
+""" Compare the endstop polling of the stepper ISR with ENDSTOP_INTERRUPTS on homing moves.
+
+A homing move runs at a constant step rate with the steps per interrupt of ADAPTIVE_STEP_LOOPS
+(see simulate_stepper.py). The endstop closes at a random moment and both ways of reading it
+are replayed on the same timeline:
+
+  polling     the stepper ISR reads the pin before its steps and needs two triggered reads
+              in a row (the old_*_endstop bookkeeping), so the hit is seen one to two
+              interrupts after the switch closes
+  interrupts  the pin change interrupt runs when the switch closes, or when the stepper ISR
+              that is running returns, since the stepper ISR keeps the interrupts off
+
+For each the latency from the switch closing to the latch of count_position is reported, the
+steps the latched position is past the switch and the steps taken in all before the block
+stops. The spread of the latched position is what limits the homing repeatability. The exit
+status is 1 if the interrupts are worse than the polling for any rate.
+
+The cycle counts are estimates for an ATmega2560, not measurements on hardware.
+"""
+
+from __future__ import division, print_function
+
+import argparse
+import random
+import sys
+
+from simulate_stepper import F_CPU, adaptive_loops
+
+__license__ = "GPL"
+
+# Estimated ATmega2560 cycles
+ISR_BASE_CYCLES = 300       # stepper ISR without the steps: block handling, directions, speed generator
+STEP_CYCLES = 70            # one iteration of the step loop
+POLL_CYCLES = 30            # READ() of one endstop with the old_*_endstop bookkeeping
+PIN_ISR_CYCLES = 90         # entry, endstop_check() and return of the pin change interrupt
+
+# Homing rates of Configuration.h in steps/s: X/Y at 50 mm/s, Z at 4 mm/s with 36.36 and 640 steps/mm
+HOMING_RATES = [("X/Y", 50 * 36.36), ("Z", 4 * 640), ("fast", 20000), ("max", 40000)]
+
+
+def isr_schedule(step_rate, count):
+    """ Start times (s), durations (s) and steps of the first count stepper interrupts """
+    step_rate, loops = adaptive_loops(int(step_rate), 1)
+    interval = 1.0 / step_rate
+    duration = (ISR_BASE_CYCLES + STEP_CYCLES * loops) / F_CPU
+    return [(i * interval, duration, loops) for i in range(count)]
+
+
+def polling(schedule, close):
+    """ Latch time and latched steps of the polling, plus the steps taken until the block stops """
+    steps = 0
+    old = False
+    for start, _, loops in schedule:
+        triggered = start + POLL_CYCLES / F_CPU >= close
+        if triggered and old:
+            # The loop of this interrupt still takes its first step before it ends the block
+            return start, steps, steps + 1
+        old = triggered
+        steps += loops
+    raise ValueError("the endstop was never seen")
+
+
+def interrupts(schedule, close):
+    """ Latch time and latched steps of ENDSTOP_INTERRUPTS, plus the steps taken until the block stops """
+    steps = 0
+    for start, duration, loops in schedule:
+        if close < start:
+            # The pin interrupt runs between two stepper interrupts, the next one takes one step
+            return close + PIN_ISR_CYCLES / F_CPU, steps, steps + 1
+        if close < start + duration:
+            # Held off until the stepper ISR returns, it has taken its steps by then
+            return start + duration + PIN_ISR_CYCLES / F_CPU, steps + loops, steps + loops + 1
+        steps += loops
+    raise ValueError("the endstop was never seen")
+
+
+def steps_before(schedule, close):
+    """ The steps taken when the switch closes """
+    steps = 0
+    for start, duration, loops in schedule:
+        if start + duration > close:
+            break
+        steps += loops
+    return steps
+
+
+def run(step_rate, trials, rng):
+    schedule = isr_schedule(step_rate, 2000)
+    end = schedule[len(schedule) // 2][0]
+    results = {"polling": [], "interrupts": []}
+    for _ in range(trials):
+        close = rng.uniform(end / 10, end)
+        at_close = steps_before(schedule, close)
+        for name, method in (("polling", polling), ("interrupts", interrupts)):
+            latched_at, latched, stopped = method(schedule, close)
+            results[name].append((latched_at - close, latched - at_close, stopped - at_close))
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[1])
+    parser.add_argument("--trials", type=int, default=2000, help="switch closings per rate")
+    parser.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+    rng = random.Random(args.seed)
+
+    worse = False
+    print("%-6s %8s %-10s %24s %18s %10s" % ("axis", "steps/s", "method", "latency us min/mean/max",
+                                          "latched past", "overrun"))
+    for axis, rate in HOMING_RATES:
+        results = run(rate, args.trials, rng)
+        spread = {}
+        for name in ("polling", "interrupts"):
+            latency = [r[0] * 1e6 for r in results[name]]
+            latched = [r[1] for r in results[name]]
+            overrun = [r[2] for r in results[name]]
+            spread[name] = max(latched) - min(latched)
+            print("%-6s %8d %-10s %7.1f %7.1f %8.1f %9d..%-3d steps %6d max" % (
+                axis, rate, name, min(latency), sum(latency) / len(latency), max(latency),
+                min(latched), max(latched), max(overrun)))
+        if spread["interrupts"] > spread["polling"]:
+            worse = True
+
+    # What the polling costs per second of homing, three endstops are read per interrupt
+    print()
+    for axis, rate in HOMING_RATES:
+        step_rate, loops = adaptive_loops(int(rate), 1)
+        print("%-6s polling %6.2f%% of the CPU while homing" % (axis, 100.0 * 3 * POLL_CYCLES * step_rate / F_CPU))
+
+    return 1 if worse else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,458 @@
+#!/usr/bin/env python
+
+""" Check the FIXED_POINT_PLANNER math of plan_buffer_line() against the float math and count the cycles.
+
+Every move goes through both versions of the part of plan_buffer_line() that FIXED_POINT_PLANNER
+replaces: the axis deltas in mm, the length of the move, the nominal rate limited by the max feedrates
+and the acceleration limited per axis, plus the path length used for the junction deviation. The
+integer steps are done exactly like on the AVR, the float path is taken as the reference. The largest
+differences are reported per field, the exit status is 1 if any is beyond the tolerance. Integers
+that are one count off are taken as rounding.
+
+The cycles are counted per block from the operations each path takes, with rough figures for the
+avr-libc float routines and the libgcc integer helpers on an ATmega2560. The same operations in both
+paths (the junction speeds, calculate_trapezoid_for_block()) are left out.
+
+Without an input file the moves of a test layer (see simulate_planner.py) are used, with a peel move
+between the layers, plus random moves over all axes.
+"""
+
+from __future__ import division, print_function
+
+import argparse
+import math
+import random
+import sys
+
+from simulate_planner import MAX_FEEDRATE, MAX_ACCELERATION, ACCELERATION, Move, parse_gcode, test_layer
+
+__license__ = "GPL"
+
+# Configuration.h / Configuration_adv.h defaults
+AXIS_STEPS_PER_UNIT = [36.36, 36.36, 640.0, 640.0]
+RETRACT_ACCELERATION = 2000.0
+DROPSEGMENTS = 1
+F_CPU = 16000000
+
+# The block_t fields that are integers
+INTEGER_FIELDS = ('nominal_rate', 'acceleration_st', 'acceleration_rate')
+
+# Rough cycles of the soft float routines of avr-libc and the integer helpers of libgcc, call included
+CYCLES = {
+    'fadd': 110, 'fmul': 150, 'fdiv': 480, 'fsqrt': 500, 'fcmp': 60, 'ceil': 110, 'ldexp': 40,
+    'i2f': 80, 'f2i': 90, 'mul16': 20, 'mul32': 50, 'shift32': 6, 'op32': 5, 'isqrt_bit': 30,
+}
+
+
+def lround(x):
+    return int(math.floor(abs(x) + 0.5)) * (1 if x >= 0 else -1)
+
+
+class Counter(object):
+    def __init__(self):
+        self.ops = {}
+
+    def __call__(self, op, n=1):
+        self.ops[op] = self.ops.get(op, 0) + n
+
+    def cycles(self):
+        return sum(CYCLES[op] * n for op, n in self.ops.items())
+
+
+class Settings(object):
+    """ reset_acceleration_rates() and reset_fixed_point_constants() """
+    def __init__(self, steps_per_unit, max_feedrate):
+        self.steps_per_unit = steps_per_unit
+        self.axis_steps_per_sqr_second = [int(a * s) for a, s in zip(MAX_ACCELERATION, steps_per_unit)]
+        self.length_per_step = []
+        self.length_unit_shift = []
+        for s in steps_per_unit:
+            mantissa, exponent = math.frexp(1.0 / s)
+            mantissa = lround(math.ldexp(mantissa, 16))
+            if mantissa > 0xFFFF:
+                mantissa >>= 1
+                exponent += 1
+            self.length_per_step.append(mantissa)
+            self.length_unit_shift.append(16 - exponent)
+        max_rate = max(f * s for f, s in zip(max_feedrate, steps_per_unit))
+        self.max_step_rate_shift = 0
+        while math.ldexp(max_rate, -self.max_step_rate_shift) > 65535:
+            self.max_step_rate_shift += 1
+        self.max_step_rate = [min(lround(math.ldexp(f * s, -self.max_step_rate_shift)), 65535)
+                              for f, s in zip(max_feedrate, steps_per_unit)]
+
+
+def isqrt(x, count):
+    root = 0
+    bit = 1 << 30
+    while bit > x:
+        bit >>= 2
+    while bit:
+        count('isqrt_bit')
+        if x >= root + bit:
+            x -= root + bit
+            root = (root >> 1) + bit
+        else:
+            root >>= 1
+        bit >>= 2
+    if x > root:
+        root += 1
+    return root
+
+
+def fixed_length(a, exponent, count):
+    top = None
+    for m, e in zip(a, exponent):
+        if m == 0:
+            continue
+        while m > 0x7FFF:
+            m >>= 1
+            e += 1
+            count('shift32')
+        while m < 0x4000:
+            m <<= 1
+            e -= 1
+            count('shift32')
+        top = e if top is None else max(top, e)
+    if top is None:
+        return 0.0
+    total = 0
+    for c, e in zip(a, exponent):
+        if c == 0:
+            continue
+        shift = top - e
+        count('shift32', min(abs(shift), 32))
+        c = 0 if shift >= 32 else c >> shift if shift >= 0 else c << -shift
+        total += c * c
+    count('mul16', len(a))
+    count('op32', len(a))
+    length = math.ldexp(isqrt(total, count), top)
+    count('i2f')
+    count('ldexp')
+    return length
+
+
+def float_block(steps, delta_steps, feed_rate, settings, count):
+    """ The float path, delta_steps are signed """
+    block = {}
+    events = max(steps)
+    delta = [float(d) / s for d, s in zip(delta_steps, settings.steps_per_unit)]
+    count('i2f', 5)
+    count('fdiv', 5)
+    count('fmul')
+    if max(steps[:3]) <= DROPSEGMENTS:
+        millimeters = abs(delta[3])
+    else:
+        millimeters = math.sqrt(sum(d * d for d in delta[:3]))
+        count('fmul', 3)
+        count('fadd', 2)
+        count('fsqrt')
+    block['millimeters'] = millimeters
+    inverse_millimeters = 1.0 / millimeters
+    inverse_second = feed_rate * inverse_millimeters
+    count('fdiv')
+    count('fmul')
+    nominal_speed = millimeters * inverse_second
+    nominal_rate = int(math.ceil(events * inverse_second))
+    count('fmul', 2)
+    count('i2f')
+    count('ceil')
+    count('f2i')
+    speed_factor = 1.0
+    max_speed_factor = 1e9
+    current_speed = [d * inverse_second for d in delta]
+    count('fmul', 4)
+    for i in range(4):
+        count('fcmp')
+        if abs(current_speed[i]) > MAX_FEEDRATE[i]:
+            speed_factor = min(speed_factor, MAX_FEEDRATE[i] / abs(current_speed[i]))
+            count('fdiv')
+            count('fcmp')
+        # LIVE_FEEDRATE_OVERRIDE
+        count('fcmp')
+        if current_speed[i] != 0:
+            max_speed_factor = min(max_speed_factor, MAX_FEEDRATE[i] / abs(current_speed[i]))
+            count('fdiv')
+            count('fcmp')
+    block['max_nominal_speed'] = nominal_speed * max_speed_factor
+    count('fmul')
+    count('fcmp')
+    if speed_factor < 1.0:
+        nominal_speed *= speed_factor
+        nominal_rate = int(nominal_rate * speed_factor)
+        count('fmul', 6)
+        count('i2f')
+        count('f2i')
+    block['nominal_speed'] = nominal_speed
+    block['nominal_rate'] = nominal_rate
+
+    steps_per_mm = events / millimeters
+    count('i2f')
+    count('fdiv')
+    axis_steps_per_sqr_second = settings.axis_steps_per_sqr_second
+    if steps[0] == 0 and steps[1] == 0 and steps[2] == 0:
+        acceleration_st = int(math.ceil(RETRACT_ACCELERATION * steps_per_mm))
+        count('fmul')
+        count('ceil')
+        count('f2i')
+    else:
+        acceleration_st = int(math.ceil(ACCELERATION * steps_per_mm))
+        count('fmul')
+        count('ceil')
+        count('f2i')
+        for i in (0, 1, 3, 2):
+            count('i2f', 4)
+            count('fmul')
+            count('fdiv')
+            count('fcmp')
+            if float(acceleration_st) * steps[i] / events > axis_steps_per_sqr_second[i]:
+                acceleration_st = axis_steps_per_sqr_second[i]
+    block['acceleration_st'] = acceleration_st
+    block['acceleration'] = acceleration_st / steps_per_mm
+    block['acceleration_rate'] = int(acceleration_st * (16777216.0 / (F_CPU / 8.0)))
+    count('i2f', 2)
+    count('fdiv')
+    count('fmul')
+    count('f2i')
+
+    # JUNCTION_DEVIATION
+    block['length'] = math.sqrt(sum(d * d for d in delta))
+    count('fmul', 4)
+    count('fadd', 3)
+    count('fsqrt')
+    count('fdiv')
+    return block
+
+
+def mantissa(value, count):
+    """ A step count as a 16 bit mantissa and an exponent """
+    shift = 0
+    while value >> shift > 0xFFFF:
+        shift += 1
+    count('shift32', shift * 2)
+    count('op32', shift + 1)
+    return value >> shift, shift
+
+
+def scaled_greater(a, a_shift, b, b_shift, count):
+    count('shift32', abs(a_shift - b_shift))
+    count('op32')
+    if a_shift > b_shift:
+        b >>= a_shift - b_shift
+    else:
+        a >>= b_shift - a_shift
+    return a > b
+
+
+def fixed_block(steps, directions, feed_rate, settings, count):
+    """ The FIXED_POINT_PLANNER path """
+    block = {}
+    events = max(steps)
+    scaled = []
+    steps_shift = []
+    length = []
+    exponent = []
+    for s, l, unit_shift in zip(steps, settings.length_per_step, settings.length_unit_shift):
+        m, shift = mantissa(s, count)
+        scaled.append(m)
+        steps_shift.append(shift)
+        length.append(m * l)
+        exponent.append(shift - unit_shift)
+    count('mul16', 4)
+    delta = [math.ldexp(l, e) * (-1 if negative else 1) for l, e, negative in zip(length, exponent, directions)]
+    count('i2f', 4)
+    count('ldexp', 4)
+    if max(steps[:3]) <= DROPSEGMENTS:
+        millimeters = abs(delta[3])
+    else:
+        millimeters = fixed_length(length[:3], exponent[:3], count)
+    block['millimeters'] = millimeters
+    inverse_millimeters = 1.0 / millimeters
+    inverse_second = feed_rate * inverse_millimeters
+    count('fdiv')
+    count('fmul')
+    nominal_speed = millimeters * inverse_second
+    nominal_rate = int(math.ceil(events * inverse_second))
+    count('fmul', 2)
+    count('i2f')
+    count('ceil')
+    count('f2i')
+
+    limit_axis = 0
+    for i in range(1, 4):
+        count('mul16', 2)
+        if scaled_greater(scaled[i] * settings.max_step_rate[limit_axis], steps_shift[i],
+                          scaled[limit_axis] * settings.max_step_rate[i], steps_shift[limit_axis], count):
+            limit_axis = i
+    limit_axis_rate = steps[limit_axis] * inverse_second
+    limit_axis_max_rate = math.ldexp(settings.max_step_rate[limit_axis], settings.max_step_rate_shift)
+    count('i2f', 2)
+    count('fmul')
+    count('ldexp')
+    # LIVE_FEEDRATE_OVERRIDE
+    max_speed_factor = limit_axis_max_rate / limit_axis_rate
+    count('fdiv')
+    count('fcmp')
+    speed_factor = min(max_speed_factor, 1.0)
+    count('fmul', 4)
+    block['max_nominal_speed'] = nominal_speed * max_speed_factor
+    count('fmul')
+    count('fcmp')
+    if speed_factor < 1.0:
+        nominal_speed *= speed_factor
+        nominal_rate = int(nominal_rate * speed_factor)
+        count('fmul', 6)
+        count('i2f')
+        count('f2i')
+    block['nominal_speed'] = nominal_speed
+    block['nominal_rate'] = nominal_rate
+
+    steps_per_mm = events * inverse_millimeters
+    count('i2f')
+    count('fmul')
+    axis_steps_per_sqr_second = settings.axis_steps_per_sqr_second
+    retract = steps[0] == 0 and steps[1] == 0 and steps[2] == 0
+    acceleration = RETRACT_ACCELERATION if retract else ACCELERATION
+    acceleration_st = int(math.ceil(acceleration * steps_per_mm))
+    count('fmul')
+    count('ceil')
+    count('f2i')
+    if not retract:
+        unlimited = acceleration_st
+        step_events, step_events_shift = mantissa(events, count)
+        for i in (0, 1, 3, 2):
+            limit = axis_steps_per_sqr_second[i]
+            count('op32')
+            if acceleration_st <= limit:
+                continue
+            a = acceleration_st
+            while a > 0xFFFF:
+                a >>= 1
+                limit >>= 1
+                count('shift32', 2)
+            count('mul16', 2)
+            if scaled_greater(a * scaled[i], steps_shift[i] - step_events_shift, limit * step_events, 0, count):
+                acceleration_st = axis_steps_per_sqr_second[i]
+        if acceleration_st != unlimited:
+            acceleration = acceleration_st / steps_per_mm
+            count('i2f')
+            count('fdiv')
+    block['acceleration_st'] = acceleration_st
+    block['acceleration'] = acceleration
+    factor = 16777216.0 / (F_CPU / 8.0)
+    rate_int = int(factor)
+    rate_fraction = int((factor - rate_int) * 65536.0 + 0.5)
+    block['acceleration_rate'] = (acceleration_st * rate_int + (acceleration_st >> 16) * rate_fraction +
+                                  (((acceleration_st & 0xFFFF) * rate_fraction) >> 16)) & 0xFFFFFFFF
+    count('mul32')
+    count('mul16', 2)
+    count('shift32', 16)
+    count('op32', 2)
+
+    # JUNCTION_DEVIATION
+    block['length'] = fixed_length(length, exponent, count)
+    count('fdiv')
+    return block
+
+
+def random_moves(count, seed):
+    """ Moves over all axes from a single step up to the size of the build area, with feedrates beyond
+    the max ones. E follows Z like on the mUVe 1. """
+    rng = random.Random(seed)
+    pos = [0.0, 0.0, 0.0, 0.0]
+    moves = []
+    for i in range(count):
+        kind = rng.random()
+        scale = 10 ** rng.uniform(-2, 2.4)
+        target = list(pos)
+        if kind < 0.6:
+            target[0] = round(pos[0] + rng.uniform(-1, 1) * scale, 3)
+            target[1] = round(pos[1] + rng.uniform(-1, 1) * scale, 3)
+        elif kind < 0.8:
+            target[2] = round(pos[2] + rng.uniform(-1, 1) * scale / 4, 3)
+        else:
+            target[0] = round(pos[0] + rng.uniform(-1, 1) * scale, 3)
+            target[1] = round(pos[1] + rng.uniform(-1, 1) * scale, 3)
+            target[2] = round(pos[2] + rng.uniform(-1, 1) * scale / 10, 3)
+        target[3] = target[2]
+        moves.append(Move(pos, target, 10 ** rng.uniform(-0.5, 3)))
+        pos = target
+    return moves
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('input', nargs='?', help='G-code file, a test layer and random moves are used when omitted')
+    parser.add_argument('--steps', default=",".join(str(s) for s in AXIS_STEPS_PER_UNIT),
+                        help='steps per unit of X,Y,Z,E (default=%(default)s)')
+    parser.add_argument('-r', '--random', type=int, default=20000, help='number of random moves (default=20000)')
+    parser.add_argument('--seed', type=int, default=1, help='seed of the random moves')
+    parser.add_argument('-t', '--tolerance', type=float, default=2e-4,
+                        help='largest relative difference to the float path (default=2e-4)')
+    args = parser.parse_args()
+
+    spu = [float(s) for s in args.steps.split(",")]
+    settings = Settings(spu, MAX_FEEDRATE)
+    print("step lengths %s, max step rates %s" %
+          (", ".join("%d*2^-%d mm" % l for l in zip(settings.length_per_step, settings.length_unit_shift)),
+           settings.max_step_rate))
+
+    if args.input:
+        sets = [("G-code", sum(parse_gcode(args.input), []))]
+    else:
+        layer = test_layer(100.0, 0.1, 20.0, 720, 0.5)[0]
+        for move in layer:
+            move.end[3] = move.end[2]
+        peel = [Move([0, 0, 0, 0], [0, 0, 5.0, 5.0], 4.0), Move([0, 0, 5.0, 5.0], [0, 0, 0.05, 0.05], 4.0)]
+        sets = [("test layer", peel + layer), ("random", random_moves(args.random, args.seed))]
+
+    fields = ['millimeters', 'length', 'nominal_speed', 'max_nominal_speed', 'nominal_rate', 'acceleration',
+              'acceleration_st', 'acceleration_rate']
+    failed = False
+    for name, moves in sets:
+        position = [lround(v * s) for v, s in zip(moves[0].start, spu)]
+        worst = dict((f, 0.0) for f in fields)
+        exact = dict((f, 0) for f in fields)
+        off = dict((f, 0) for f in fields)
+        cycles = [[], []]
+        blocks = 0
+        for move in moves:
+            target = [lround(v * s) for v, s in zip(move.end, spu)]
+            delta_steps = [t - p for t, p in zip(target, position)]
+            steps = [abs(d) for d in delta_steps]
+            if max(steps) <= DROPSEGMENTS:
+                continue
+            float_count, fixed_count = Counter(), Counter()
+            reference = float_block(steps, delta_steps, move.feedrate, settings, float_count)
+            fixed = fixed_block(steps, [d < 0 for d in delta_steps], move.feedrate, settings, fixed_count)
+            for f in fields:
+                difference = abs(fixed[f] - reference[f])
+                error = difference / max(abs(reference[f]), 1e-9)
+                worst[f] = max(worst[f], error)
+                exact[f] += fixed[f] == reference[f]
+                # Integers one count off are rounding, not an error
+                if f in INTEGER_FIELDS and difference <= 1:
+                    error = 0.0
+                if error > args.tolerance:
+                    off[f] += 1
+            cycles[0].append(float_count.cycles())
+            cycles[1].append(fixed_count.cycles())
+            blocks += 1
+            position = target
+        print()
+        print("%s: %d blocks" % (name, blocks))
+        print("  field                largest error    same  beyond tolerance")
+        for f in fields:
+            print("  %-18s %13.2e %6.1f%% %8d" % (f, worst[f], 100.0 * exact[f] / max(blocks, 1), off[f]))
+            failed = failed or off[f] > 0
+        for label, c in zip(("float", "fixed point"), cycles):
+            print("  %-12s %6.0f cycles per block on average, %5.0f at most, %.0f us at %d MHz" %
+                  (label, sum(c) / float(max(len(c), 1)), max(c or [0]), sum(c) / float(max(len(c), 1)) * 1e6 / F_CPU,
+                   F_CPU / 1000000))
+    print()
+    print("FAILED" if failed else "all blocks within %g of the float path" % args.tolerance)
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
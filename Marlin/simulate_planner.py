@@ -0,0 +1,286 @@
+#!/usr/bin/env python
+
+""" Compare the jerk and junction deviation cornering models of the planner on a G-code file.
+
+Every move is run through the same steps as plan_buffer_line(): nominal speed, acceleration
+limited per axis, the maximum junction speed from one of the two models, then the look-ahead
+over BLOCK_BUFFER_SIZE blocks (the block at the end of the buffer always exits at
+MINIMUM_PLANNER_SPEED). The time of every block is taken from its trapezoid.
+
+Without an input file a mUVe style test layer is generated: a polygonal contour with shallow
+joins and a zigzag hatch fill. Layers are split on Z moves.
+
+With --coalesce the moves are first joined like SEGMENT_COALESCING does in prepare_move(): XY
+moves that go on in the same direction with the same feedrate and E per mm, as long as the joints
+stay within the tolerance. The merge ratio is reported with the times.
+"""
+
+from __future__ import print_function
+
+import argparse
+import math
+import re
+
+__license__ = "GPL"
+
+# Configuration.h / Configuration_adv.h defaults
+MAX_FEEDRATE = [500.0, 500.0, 4.0, 4.0]
+MAX_ACCELERATION = [2600.0, 2600.0, 2.5, 2.5]
+ACCELERATION = 2000.0
+MINIMUM_PLANNER_SPEED = 0.05
+BLOCK_BUFFER_SIZE = 16
+
+WORD = re.compile(r"([A-Z])\s*([-+]?[0-9]*\.?[0-9]*)")
+
+
+class Block(object):
+    def __init__(self, delta, feedrate):
+        self.delta = delta
+        self.millimeters = math.sqrt(sum(d * d for d in delta[:3])) or abs(delta[3])
+        self.speed = [d / self.millimeters * feedrate for d in delta]
+        factor = 1.0
+        for i in range(4):
+            if abs(self.speed[i]) > MAX_FEEDRATE[i]:
+                factor = min(factor, MAX_FEEDRATE[i] / abs(self.speed[i]))
+        self.speed = [s * factor for s in self.speed]
+        self.nominal_speed = feedrate * factor
+        self.acceleration = ACCELERATION
+        for i in range(4):
+            share = abs(delta[i]) / self.millimeters
+            if share > 0 and self.acceleration * share > MAX_ACCELERATION[i]:
+                self.acceleration = MAX_ACCELERATION[i] / share
+        length = math.sqrt(sum(d * d for d in delta))
+        self.unit = [d / length for d in delta]
+        self.max_entry_speed = MINIMUM_PLANNER_SPEED
+
+
+def jerk_junction(prev, block, xy_jerk, z_jerk, e_jerk):
+    if prev is None:
+        return min(xy_jerk / 2, block.nominal_speed)
+    jerk = math.hypot(block.speed[0] - prev.speed[0], block.speed[1] - prev.speed[1])
+    factor = 1.0
+    if jerk > xy_jerk:
+        factor = xy_jerk / jerk
+    dz = abs(block.speed[2] - prev.speed[2])
+    if dz > z_jerk:
+        factor = min(factor, z_jerk / dz)
+    de = abs(block.speed[3] - prev.speed[3])
+    if de > e_jerk:
+        factor = min(factor, e_jerk / de)
+    return min(prev.nominal_speed, block.nominal_speed * factor)
+
+
+def deviation_junction(prev, block, deviation):
+    if prev is None:
+        return MINIMUM_PLANNER_SPEED
+    cos_theta = -sum(p * u for p, u in zip(prev.unit, block.unit))
+    if cos_theta >= 0.95:
+        return MINIMUM_PLANNER_SPEED
+    vmax = min(prev.nominal_speed, block.nominal_speed)
+    if cos_theta > -0.95:
+        sin_theta_d2 = math.sqrt(0.5 * (1.0 - cos_theta))
+        vmax = min(vmax, math.sqrt(block.acceleration * deviation * sin_theta_d2 / (1.0 - sin_theta_d2)))
+    return vmax
+
+
+def max_allowable_speed(acceleration, target_velocity, distance):
+    return math.sqrt(target_velocity * target_velocity + 2 * acceleration * distance)
+
+
+def trapezoid_time(block, entry, exit_speed):
+    a, length, v = block.acceleration, block.millimeters, block.nominal_speed
+    accel_dist = (v * v - entry * entry) / (2 * a)
+    decel_dist = (v * v - exit_speed * exit_speed) / (2 * a)
+    if accel_dist + decel_dist > length:
+        # no plateau, meet at the intersection like intersection_distance() in the planner
+        accel_dist = (2 * a * length - entry * entry + exit_speed * exit_speed) / (4 * a)
+        accel_dist = max(0.0, min(length, accel_dist))
+        v = math.sqrt(entry * entry + 2 * a * accel_dist)
+        decel_dist = length - accel_dist
+    cruise = length - accel_dist - decel_dist
+    return (v - entry) / a + (v - exit_speed) / a + cruise / v
+
+
+def simulate(blocks, junction):
+    prev = None
+    for block in blocks:
+        block.max_entry_speed = junction(prev, block)
+        prev = block
+    # The stepper runs block i while the planner sees up to BLOCK_BUFFER_SIZE-1 blocks after it
+    times = []
+    entries = []
+    entry = MINIMUM_PLANNER_SPEED
+    for i, block in enumerate(blocks):
+        window = blocks[i:i + BLOCK_BUFFER_SIZE]
+        exit_speed = MINIMUM_PLANNER_SPEED
+        for later in reversed(window[1:]):
+            exit_speed = min(later.max_entry_speed, max_allowable_speed(later.acceleration, exit_speed, later.millimeters))
+        exit_speed = min(exit_speed, max_allowable_speed(block.acceleration, entry, block.millimeters))
+        entries.append(entry)
+        times.append(trapezoid_time(block, entry, exit_speed))
+        entry = exit_speed
+    return times, entries
+
+
+class Move(object):
+    def __init__(self, start, end, feedrate):
+        self.start = start
+        self.end = end
+        self.feedrate = feedrate
+
+    def delta(self):
+        return [b - a for a, b in zip(self.start, self.end)]
+
+
+def coalesce(moves, tolerance, max_length):
+    """ Joins the moves the way coalesce_move() in Marlin_main.cpp does """
+    joined = []
+    pending = None
+    for move in moves:
+        d = move.delta()
+        xy = math.hypot(d[0], d[1])
+        if xy == 0 or d[2] != 0:
+            if pending:
+                joined.append(pending)
+                pending = None
+            joined.append(move)
+            continue
+        e_per_mm = d[3] / xy
+        if pending and move.feedrate == pending.feedrate and abs(e_per_mm - pending.e_per_mm) <= 0.01 * abs(pending.e_per_mm):
+            ex, ey = move.end[0] - pending.start[0], move.end[1] - pending.start[1]
+            along = ex * pending.direction[0] + ey * pending.direction[1]
+            across = ex * pending.direction[1] - ey * pending.direction[0]
+            if d[0] * pending.direction[0] + d[1] * pending.direction[1] > 0 and along <= max_length and \
+                    abs(across) <= tolerance / 2:
+                pending.end = move.end
+                continue
+        if pending:
+            joined.append(pending)
+        pending = Move(move.start, move.end, move.feedrate)
+        pending.direction = (d[0] / xy, d[1] / xy)
+        pending.e_per_mm = e_per_mm
+    if pending:
+        joined.append(pending)
+    return joined
+
+
+def parse_gcode(path):
+    """ Returns the moves of every layer """
+    layers = [[]]
+    pos = [0.0, 0.0, 0.0, 0.0]
+    feedrate = 1500.0 / 60
+    relative = False
+    with open(path) as f:
+        for raw in f:
+            line = raw.split(";", 1)[0].strip().upper()
+            words = dict((k, float(v) if v else 0.0) for k, v in WORD.findall(line))
+            if "G" not in words:
+                continue
+            g = int(words["G"])
+            if g == 90:
+                relative = False
+            elif g == 91:
+                relative = True
+            elif g == 92:
+                for i, axis in enumerate("XYZE"):
+                    if axis in words:
+                        pos[i] = words[axis]
+            elif g in (0, 1):
+                if "F" in words and words["F"] > 0:
+                    feedrate = words["F"] / 60
+                target = list(pos)
+                for i, axis in enumerate("XYZE"):
+                    if axis in words:
+                        target[i] = words[axis] + (pos[i] if relative else 0.0)
+                delta = [t - p for t, p in zip(target, pos)]
+                if not any(abs(d) > 1e-6 for d in delta):
+                    continue
+                if delta[2] != 0 and layers[-1]:
+                    layers.append([])
+                layers[-1].append(Move(pos, target, feedrate))
+                pos = target
+    return [layer for layer in layers if layer]
+
+
+def test_layer(feedrate, spacing, size, sides, split):
+    """ The hatch lines are cut every split mm when split is given, the coordinates are rounded to
+    3 decimals like in a G-code file. E runs at 1 per mm to fire the laser (LASER_FIRE_E). """
+    points = []
+    radius = size / 2.0
+    for i in range(sides + 1):
+        a = 2 * math.pi * i / sides
+        points.append((radius * math.cos(a), radius * math.sin(a)))
+    y = -radius + spacing
+    direction = 1
+    while y < radius:
+        half = math.sqrt(radius * radius - y * y)
+        start, end = -half * direction, half * direction
+        pieces = max(1, int(math.ceil(2 * half / split))) if split else 1
+        for i in range(pieces + 1):
+            points.append((start + (end - start) * i / pieces, y))
+        direction = -direction
+        y += spacing
+    moves = []
+    pos = [round(points[0][0], 3), round(points[0][1], 3), 0.0, 0.0]
+    for x, y in points[1:]:
+        target = [round(x, 3), round(y, 3), 0.0, 0.0]
+        length = math.hypot(target[0] - pos[0], target[1] - pos[1])
+        if length == 0:
+            continue
+        target[3] = pos[3] + length
+        moves.append(Move(pos, target, feedrate))
+        pos = target
+    return [moves]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('input', nargs='?', help='G-code file, a test layer is generated when omitted')
+    parser.add_argument('-j', '--deviation', type=float, default=0.02, help='junction deviation in mm (default=0.02)')
+    parser.add_argument('-x', '--xy-jerk', type=float, default=0.0, help='max XY jerk in mm/s (default=0.0)')
+    parser.add_argument('-z', '--z-jerk', type=float, default=0.0, help='max Z jerk in mm/s (default=0.0)')
+    parser.add_argument('-e', '--e-jerk', type=float, default=0.0, help='max E jerk in mm/s (default=0.0)')
+    parser.add_argument('-f', '--feedrate', type=float, default=100.0, help='test layer feedrate in mm/s (default=100)')
+    parser.add_argument('-s', '--split', type=float, default=0.0, help='cut the test layer hatch lines every SPLIT mm')
+    parser.add_argument('--coalesce', type=float, default=0.0, help='join collinear moves within this tolerance in mm first')
+    parser.add_argument('--coalesce-max', type=float, default=100.0, help='longest joined move in mm (default=100)')
+    parser.add_argument('--corners', help='write the junction speeds of both models to this CSV file')
+    args = parser.parse_args()
+
+    if args.input:
+        layers = parse_gcode(args.input)
+    else:
+        layers = test_layer(args.feedrate, 0.1, 20.0, 720, args.split)
+    moves = sum(len(layer) for layer in layers)
+    if args.coalesce > 0:
+        layers = [coalesce(layer, args.coalesce, args.coalesce_max) for layer in layers]
+        joined = sum(len(layer) for layer in layers)
+        print("coalescing: %d moves into %d blocks, merge ratio %.2f" % (moves, joined, float(moves) / max(joined, 1)))
+    # MUVE_Z_PEEL: E in the G-code only fires the laser, the planner gets the Z travel for the second Z motor
+    layers = [[Block(move.delta()[:3] + [move.delta()[2]], move.feedrate) for move in layer] for layer in layers]
+
+    jerk = lambda prev, block: jerk_junction(prev, block, args.xy_jerk, args.z_jerk, args.e_jerk)
+    deviation = lambda prev, block: deviation_junction(prev, block, args.deviation)
+
+    csv = open(args.corners, "w") if args.corners else None
+    if csv:
+        csv.write("layer,block,nominal,jerk,deviation\n")
+    total = [0.0, 0.0]
+    print("layer  blocks   jerk (s)  deviation (s)  slow corners jerk/deviation")
+    for n, layer in enumerate(layers):
+        jerk_times, jerk_entries = simulate(layer, jerk)
+        dev_times, dev_entries = simulate(layer, deviation)
+        slow = [sum(1 for b, v in zip(layer, entries) if v < 0.1 * b.nominal_speed) for entries in (jerk_entries, dev_entries)]
+        total[0] += sum(jerk_times)
+        total[1] += sum(dev_times)
+        print("%5d %7d %10.2f %14.2f %8d/%d" % (n, len(layer), sum(jerk_times), sum(dev_times), slow[0], slow[1]))
+        if csv:
+            for i, block in enumerate(layer):
+                csv.write("%d,%d,%.3f,%.3f,%.3f\n" % (n, i, block.nominal_speed, jerk_entries[i], dev_entries[i]))
+    if csv:
+        csv.close()
+    print("total %18.2f %14.2f  (%.1f%% of the jerk time)" % (total[0], total[1], 100.0 * total[1] / max(total[0], 1e-9)))
+
+
+if __name__ == '__main__':
+    main()
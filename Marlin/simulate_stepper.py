@@ -0,0 +1,323 @@
+#!/usr/bin/env python
+
+""" Run one block through the stepper ISR speed generator and look at the step timestamps.
+
+The trapezoid is set up the way calculate_trapezoid_for_block() does it and every ISR
+iteration is replayed with the same integer arithmetic as stepper.cpp: the linear ramps
+of MultiU24X24toH16() and the Bezier ramps of S_CURVE_ACCELERATION. From the timestamps
+the speed, acceleration and jerk are sampled every 2 ms, so a profile can be checked
+for acceleration steps and for how close it ends at the planned final rate.
+
+With --step-loops the steps per interrupt of ADAPTIVE_STEP_LOOPS are compared with the fixed
+1/2/4 scheme: interrupt frequency and step jitter at cruise rates across the switch points, and
+how often hatch lines with rates close to a switch point change the setting.
+
+The cost of the speed generator is estimated as well: how often the ISR converts a rate to
+a timer interval with calc_timer(), and what an interval recurrence per step would do instead.
+The cycle counts are estimates from the avr-gcc output, not measurements on hardware.
+"""
+
+from __future__ import print_function
+
+import argparse
+import math
+
+__license__ = "GPL"
+
+F_CPU = 16000000
+TIMER_FREQ = F_CPU // 8
+MAX_STEP_FREQUENCY = 40000
+
+# Estimated ATmega2560 cycles
+CALC_TIMER_CYCLES = 65      # two pgm_read_word_near, the 16x8 multiply and the step_loops selection
+DIVISION_CYCLES = 600       # 32/32 bit division of libgcc, needed by the exact recurrence
+
+
+# Configuration_adv.h, ADAPTIVE_STEP_LOOPS
+MAX_STEP_ISR_FREQUENCY = 10000
+STEP_LOOPS_HYSTERESIS = 5
+STEP_LOOPS = [1, 2, 3, 4, 8]
+
+
+def adaptive_loops(step_rate, loops):
+    """ The steps per interrupt of ADAPTIVE_STEP_LOOPS, loops is the current setting """
+    loops = max(loops, 1)
+    down = MAX_STEP_ISR_FREQUENCY * (100 - STEP_LOOPS_HYSTERESIS) // 100
+    while loops < 8 and step_rate > loops * MAX_STEP_ISR_FREQUENCY:
+        loops = STEP_LOOPS[STEP_LOOPS.index(loops) + 1]
+    while loops > 1 and step_rate < STEP_LOOPS[STEP_LOOPS.index(loops) - 1] * down:
+        loops = STEP_LOOPS[STEP_LOOPS.index(loops) - 1]
+    if loops == 3:
+        return (step_rate * 21846) >> 16, loops
+    return step_rate >> {1: 0, 2: 1, 4: 2, 8: 3}[loops], loops
+
+
+def calc_timer(step_rate, loops=1, adaptive=True):
+    # speed_lookuptable_* interpolate TIMER_FREQ / step_rate, that is close enough here
+    step_rate = min(step_rate, MAX_STEP_FREQUENCY)
+    if adaptive:
+        step_rate, loops = adaptive_loops(step_rate, loops)
+    elif step_rate > 20000:
+        step_rate, loops = step_rate >> 2, 4
+    elif step_rate > 10000:
+        step_rate, loops = step_rate >> 1, 2
+    else:
+        loops = 1
+    step_rate = max(step_rate, F_CPU // 500000)
+    return max(100, TIMER_FREQ // step_rate), loops
+
+
+def mul24x24h16(a, b):
+    return ((a & 0xFFFFFF) * (b & 0xFFFFFF) >> 24) & 0xFFFF
+
+
+def ramp_position(time, shift, inverse):
+    return (((time >> shift) * inverse) & 0xFFFFFFFF) >> 16
+
+
+def bezier_rate(v0, v1, t):
+    t2 = (t * t) >> 16
+    t3 = (t2 * t) >> 16
+    poly = 655360 - 15 * t + 6 * t2
+    s = (t3 * (poly >> 4)) >> 12
+    if v1 >= v0:
+        return v0 + (((v1 - v0) * s) >> 16)
+    return v0 - (((v0 - v1) * s) >> 16)
+
+
+class Block(object):
+    def __init__(self, steps, initial_rate, nominal_rate, final_rate, acceleration_st):
+        self.step_event_count = steps
+        self.nominal_rate = nominal_rate
+        self.initial_rate = max(120, initial_rate)
+        self.final_rate = max(120, final_rate)
+        a = float(acceleration_st)
+        accelerate = int(math.ceil((nominal_rate ** 2 - self.initial_rate ** 2) / (2 * a)))
+        decelerate = int(math.floor((nominal_rate ** 2 - self.final_rate ** 2) / (2 * a)))
+        plateau = steps - accelerate - decelerate
+        if plateau < 0:
+            accelerate = int(math.ceil((2 * a * steps - self.initial_rate ** 2 + self.final_rate ** 2) / (4 * a)))
+            accelerate = min(max(accelerate, 0), steps)
+            plateau = 0
+        self.accelerate_until = accelerate
+        self.decelerate_after = accelerate + plateau
+        self.acceleration_rate = int(acceleration_st * (16777216.0 / TIMER_FREQ))
+        cruise = nominal_rate
+        if plateau == 0:
+            cruise = min(cruise, int(math.sqrt(self.initial_rate ** 2 + 2.0 * a * accelerate)))
+        cruise = max(cruise, self.initial_rate, self.final_rate)
+        self.cruise_rate = cruise
+        self.ramps = []
+        for v in (self.initial_rate, self.final_rate):
+            ticks = int((cruise - v) * TIMER_FREQ / a)
+            shift = 0
+            while (ticks >> shift) > 0xFFFF:
+                shift += 1
+            self.ramps.append((ticks, shift, 0xFFFFFFFF // max(ticks >> shift, 1)))
+
+
+def run(block, scurve, stats=None, adaptive=True, nominal_loops=1):
+    """ Returns the timestamps of the ISR iterations in seconds with the number of steps each took.
+    The calc_timer() calls made in the ISR are counted in stats. nominal_loops is the setting of
+    the previous block, the planner chooses the one of this block against it. """
+    if stats is None:
+        stats = {}
+    stats["calc_timer"] = 0
+    events = []
+    now = 0
+    step_rate_prev = block.initial_rate
+    acc_step_rate = block.initial_rate
+    acceleration_time, loops = calc_timer(acc_step_rate, 1, adaptive)
+    interval = acceleration_time
+    deceleration_time = 0
+    nominal_timer, nominal_loops = calc_timer(block.nominal_rate, nominal_loops, adaptive)
+    stats["nominal_loops"] = nominal_loops
+    completed = 0
+    while completed < block.step_event_count:
+        now += interval
+        stepped = min(loops, block.step_event_count - completed)
+        completed += stepped
+        events.append((now / float(TIMER_FREQ), stepped))
+        if completed <= block.accelerate_until:
+            if scurve:
+                ticks, shift, inverse = block.ramps[0]
+                if acceleration_time < ticks:
+                    acc_step_rate = bezier_rate(block.initial_rate, block.cruise_rate, ramp_position(acceleration_time, shift, inverse))
+                else:
+                    acc_step_rate = block.cruise_rate
+            else:
+                acc_step_rate = mul24x24h16(acceleration_time, block.acceleration_rate) + block.initial_rate
+            acc_step_rate = min(acc_step_rate, block.nominal_rate)
+            interval, loops = calc_timer(acc_step_rate, loops, adaptive)
+            stats["calc_timer"] += 1
+            acceleration_time += interval
+            step_rate_prev = acc_step_rate
+        elif completed > block.decelerate_after:
+            if scurve:
+                ticks, shift, inverse = block.ramps[1]
+                if deceleration_time < ticks:
+                    step_rate = bezier_rate(block.cruise_rate, block.final_rate, ramp_position(deceleration_time, shift, inverse))
+                else:
+                    step_rate = block.final_rate
+            else:
+                step_rate = mul24x24h16(deceleration_time, block.acceleration_rate)
+                step_rate = block.final_rate if step_rate > acc_step_rate else acc_step_rate - step_rate
+            step_rate = max(step_rate, block.final_rate)
+            interval, loops = calc_timer(step_rate, loops, adaptive)
+            stats["calc_timer"] += 1
+            deceleration_time += interval
+            step_rate_prev = step_rate
+        else:
+            interval, loops = nominal_timer, nominal_loops
+            step_rate_prev = block.nominal_rate
+    return events, step_rate_prev
+
+
+def recurrence_error(block, acceleration_st):
+    """ Largest relative error of the intervals on the acceleration ramp when they are computed with
+    the per step recurrence c[n] = c[n-1] - 2 c[n-1] / (4n + 1) instead of TIMER_FREQ / v[n]. """
+    a = float(acceleration_st)
+    n = block.initial_rate ** 2 / (2 * a)  # steps an acceleration from rest would have taken
+    c = TIMER_FREQ / float(block.initial_rate)
+    worst = 0.0
+    for step in range(1, block.accelerate_until):
+        n += 1
+        c -= 2 * c / (4 * n + 1)
+        exact = TIMER_FREQ / math.sqrt(block.initial_rate ** 2 + 2 * a * step)
+        worst = max(worst, abs(c - exact) / exact)
+    return worst
+
+
+def step_jitter(events):
+    """ Highest interrupt frequency in Hz and the largest and RMS deviation in us of the steps from
+    times spread evenly over each interval. All steps of an interrupt are taken at its start. """
+    worst = 0.0
+    total = 0.0
+    count = 0
+    frequency = 0.0
+    last = 0.0
+    for t, stepped in events:
+        interval = t - last
+        frequency = max(frequency, 1 / interval)
+        for j in range(stepped):
+            error = interval * j / stepped
+            worst = max(worst, error)
+            total += error * error
+            count += 1
+        last = t
+    return frequency, worst * 1e6, math.sqrt(total / max(count, 1)) * 1e6
+
+
+def sweep():
+    """ Cruise at rates across the switch points, both schemes """
+    print("rate (steps/s)  fixed: loops  isr (Hz)  jitter max/rms (us)   adaptive: loops  isr (Hz)  jitter max/rms (us)")
+    for rate in range(8000, 42001, 2000):
+        row = []
+        for adaptive in (False, True):
+            timer, loops = calc_timer(rate, 1, adaptive)
+            events = [(timer * (i + 1) / float(TIMER_FREQ), loops) for i in range(10)]
+            frequency, worst, rms = step_jitter(events)
+            row += [loops, frequency, worst, rms]
+        print("%14d %13d %9.0f %10.1f/%-10.1f %15d %9.0f %10.1f/%.1f" % tuple([rate] + row))
+
+
+def hatch(spread, count):
+    """ Hatch lines whose nominal rates scatter around each switch point by spread percent, count
+    how often the steps per interrupt at the nominal rate change from one block to the next """
+    print("switch point  changes fixed  changes adaptive  (%d blocks, +-%.1f%%)" % (count, spread))
+    for point in (10000, 20000, 30000):
+        changes = []
+        for adaptive in (False, True):
+            previous = None
+            loops = 1
+            n = 0
+            for i in range(count):
+                rate = int(point * (1 + spread / 100.0 * math.sin(i * 2.399)))
+                loops = calc_timer(rate, loops, adaptive)[1]
+                if previous is not None and loops != previous:
+                    n += 1
+                previous = loops
+            changes.append(n)
+        print("%12d %14d %17d" % (point, changes[0], changes[1]))
+
+
+def profile(events, steps_per_mm, window):
+    """ Speed, acceleration and jerk sampled every window seconds. The speed of each ISR interval
+    is the steps it took over its length, it is interpolated between the interval midpoints. """
+    points = []
+    last = 0.0
+    for t, stepped in events:
+        points.append(((last + t) / 2, stepped / (t - last) / steps_per_mm))
+        last = t
+    speeds = []
+    i = 0
+    t = points[0][0]
+    while t <= points[-1][0]:
+        while points[i + 1][0] < t:
+            i += 1
+        (t0, v0), (t1, v1) = points[i], points[i + 1]
+        speeds.append(v0 + (v1 - v0) * (t - t0) / (t1 - t0))
+        t += window
+    accels = [(b - a) / window for a, b in zip(speeds, speeds[1:])]
+    jerks = [(b - a) / window for a, b in zip(accels, accels[1:])]
+    return speeds, accels, jerks
+
+
+def block_acceleration(args, steps_per_mm):
+    return int(math.ceil(args.acceleration * steps_per_mm))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('-l', '--length', type=float, default=20.0, help='move length in mm (default=20)')
+    parser.add_argument('-s', '--steps-per-mm', type=float, default=36.36, help='steps per mm (default=36.36)')
+    parser.add_argument('-f', '--feedrate', type=float, default=200.0, help='nominal speed in mm/s (default=200)')
+    parser.add_argument('-a', '--acceleration', type=float, default=2000.0, help='acceleration in mm/s^2 (default=2000)')
+    parser.add_argument('-e', '--entry', type=float, default=0.0, help='entry speed in mm/s (default=0)')
+    parser.add_argument('-x', '--exit', type=float, default=0.0, help='exit speed in mm/s (default=0)')
+    parser.add_argument('-w', '--window', type=float, default=0.002, help='sampling window in s (default=0.002)')
+    parser.add_argument('--csv', help='write the sampled speed profiles of both modes to this file')
+    parser.add_argument('--fixed-loops', action='store_true', help='take 1, 2 or 4 steps per interrupt like without ADAPTIVE_STEP_LOOPS')
+    parser.add_argument('--step-loops', action='store_true', help='compare the steps per interrupt of both schemes and exit')
+    args = parser.parse_args()
+
+    spm = args.steps_per_mm
+    if args.step_loops:
+        sweep()
+        print()
+        hatch(2.0, 200)
+        return
+    block = Block(int(round(args.length * spm)), int(args.entry * spm), int(math.ceil(args.feedrate * spm)),
+                  int(args.exit * spm), block_acceleration(args, spm))
+    print("steps %d, accelerate until %d, decelerate after %d, rates %d/%d/%d steps/s" %
+          (block.step_event_count, block.accelerate_until, block.decelerate_after,
+           block.initial_rate, block.nominal_rate, block.final_rate))
+    print("mode     time (s)  end rate  peak acc (mm/s^2)  peak jerk (mm/s^3)")
+    results = {}
+    counts = {}
+    for name, scurve in (("linear", False), ("s-curve", True)):
+        stats = {}
+        events, end_rate = run(block, scurve, stats, not args.fixed_loops)
+        speeds, accels, jerks = profile(events, spm, args.window)
+        results[name] = speeds
+        counts[name] = (len(events), stats["calc_timer"])
+        print("%-8s %8.4f %9d %18.0f %19.0f" % (name, events[-1][0], end_rate,
+              max(abs(a) for a in accels) if accels else 0, max(abs(j) for j in jerks) if jerks else 0))
+    print()
+    print("mode     interrupts  calc_timer  ramp cycles  recurrence cycles")
+    for name in ("linear", "s-curve"):
+        isrs, calls = counts[name]
+        print("%-8s %10d %11d %12d %18d" % (name, isrs, calls, calls * CALC_TIMER_CYCLES, calls * DIVISION_CYCLES))
+    print("block start: 2 calc_timer calls (%d cycles) moved from the ISR to the planner" % (2 * CALC_TIMER_CYCLES))
+    print("recurrence c[n] = c[n-1] - 2 c[n-1] / (4n + 1): worst interval error %.1f%% on the acceleration ramp"
+          % (100 * recurrence_error(block, block_acceleration(args, spm))))
+    if args.csv:
+        with open(args.csv, "w") as f:
+            f.write("time,linear,scurve\n")
+            for i in range(max(len(v) for v in results.values())):
+                row = [results[k][i] if i < len(results[k]) else 0.0 for k in ("linear", "s-curve")]
+                f.write("%.4f,%.3f,%.3f\n" % ((i + 1) * args.window, row[0], row[1]))
+
+
+if __name__ == '__main__':
+    main()
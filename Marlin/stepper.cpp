@@ -26,9 +26,10 @@
 #include "planner.h"
 #ifdef LASER
 #include "laser.h"
-#else
-#include "temperature.h"
 #endif // LASER
+#if !defined(LASER) || defined(LASER_ONLY)
+#include "temperature.h"
+#endif
 #include "ultralcd.h"
 #include "language.h"
 #include "cardreader.h"
@@ -72,6 +73,7 @@ static unsigned short acc_step_rate; // needed for deccelaration start point
 static char step_loops;
 static unsigned short OCR1A_nominal;
 static unsigned short step_loops_nominal;
+static volatile unsigned short step_rate_too_high = 0; // The reduced rate that needed a timer under 100, reported from the main loop
 
 volatile long endstops_trigsteps[3]={0,0,0};
 volatile long endstops_stepsTotal,endstops_stepsDone;
@@ -98,7 +100,19 @@ volatile signed char count_direction[NUM_AXIS] = { 1, 1, 1, 1};
 //=============================functions         ============================
 //===========================================================================
 
-#define CHECK_ENDSTOPS  if(check_endstops)
+#ifdef ENDSTOP_INTERRUPTS
+  // The Arduino interrupt numbers of the external interrupt pins of the ATmega1280/2560, -1 for the others
+  #define ENDSTOP_EXT_INT(pin) ((pin) == 2 ? 0 : (pin) == 3 ? 1 : (pin) == 21 ? 2 : (pin) == 20 ? 3 : (pin) == 19 ? 4 : (pin) == 18 ? 5 : -1)
+  // The pin change interrupt group (PCIEn, PCMSKn) and PCMSK bit of the pins that have one: PB0-7 (53-50, 10-13),
+  // PJ0/PJ1 (15/14) and PK0-7 (A8-A15). PE0 is RX0 and left out.
+  #define ENDSTOP_PCINT_GROUP(pin) ((pin) >= 62 && (pin) <= 69 ? 2 : (pin) == 14 || (pin) == 15 ? 1 : ((pin) >= 50 && (pin) <= 53) || ((pin) >= 10 && (pin) <= 13) ? 0 : -1)
+  #define ENDSTOP_PCINT_BIT(pin) ((pin) >= 62 ? (pin) - 62 : (pin) >= 50 ? 53 - (pin) : (pin) == 15 ? 1 : (pin) == 14 ? 2 : (pin) - 6)
+  #define ENDSTOP_HAS_INTERRUPT(pin) (ENDSTOP_EXT_INT(pin) >= 0 || ENDSTOP_PCINT_GROUP(pin) >= 0)
+  // endstop_check() reads the endstops that have a pin interrupt, the others are still polled here
+  #define CHECK_ENDSTOPS(pin)  if(check_endstops && !ENDSTOP_HAS_INTERRUPT(pin))
+#else
+  #define CHECK_ENDSTOPS(pin)  if(check_endstops)
+#endif
 
 // intRes = intIn1 * intIn2 >> 16
 // uses:
@@ -176,6 +190,20 @@ asm volatile ( \
 #define DISABLE_STEPPER_DRIVER_INTERRUPT() TIMSK1 &= ~(1<<OCIE1A)
 
 
+void checkStepperErrors()
+{
+  if (step_rate_too_high) {
+    unsigned short rate;
+    CRITICAL_SECTION_START;
+    rate = step_rate_too_high;
+    step_rate_too_high = 0;
+    CRITICAL_SECTION_END;
+    SERIAL_ERROR_START;
+    SERIAL_ERRORPGM(MSG_STEPPER_TOO_HIGH);
+    SERIAL_ERRORLN(rate);
+  }
+}
+
 void checkHitEndstops()
 {
  if( endstop_x_hit || endstop_y_hit || endstop_z_hit) {
@@ -203,14 +231,27 @@ void checkHitEndstops()
      card.sdprinting = false;
      card.closefile();
      quickStop();
+     #ifndef LASER_ONLY
      setTargetHotend0(0);
      setTargetHotend1(0);
      setTargetHotend2(0);
+     #endif
    }
 #endif
  }
 }
 
+bool endstop_trigger(int axis, long &steps)
+{
+  bool hit = (axis == X_AXIS) ? endstop_x_hit : (axis == Y_AXIS) ? endstop_y_hit : (axis == Z_AXIS) ? endstop_z_hit : false;
+  if (hit) {
+    CRITICAL_SECTION_START;
+    steps = endstops_trigsteps[axis];
+    CRITICAL_SECTION_END;
+  }
+  return hit;
+}
+
 void endstops_hit_on_purpose()
 {
   endstop_x_hit=false;
@@ -218,9 +259,106 @@ void endstops_hit_on_purpose()
   endstop_z_hit=false;
 }
 
+#ifdef ENDSTOP_INTERRUPTS
+#define ENDSTOP_HIT(AXIS, FLAG, PIN, INVERTING) \
+  if (READ(PIN) != INVERTING) { \
+    endstops_trigsteps[AXIS] = count_position[AXIS]; \
+    FLAG = true; \
+    hit = true; \
+  }
+
+// Reads the endstops in the direction the current block moves, a hit latches the position and ends the block
+// like the polling in the stepper interrupt does. Called with the interrupts off, from the pin interrupts and
+// when a block starts.
+static void endstop_check()
+{
+  block_t *block = current_block;
+  if (block == NULL || !check_endstops) return;
+  unsigned char dirs = block->direction_bits;
+  bool hit = false;
+
+  if (block->steps_x > 0) {
+    if ((dirs & (1<<X_AXIS)) != 0) {
+      #if defined(X_MIN_PIN) && X_MIN_PIN > -1
+        ENDSTOP_HIT(X_AXIS, endstop_x_hit, X_MIN_PIN, X_MIN_ENDSTOP_INVERTING);
+      #endif
+    }
+    else {
+      #if defined(X_MAX_PIN) && X_MAX_PIN > -1
+        ENDSTOP_HIT(X_AXIS, endstop_x_hit, X_MAX_PIN, X_MAX_ENDSTOP_INVERTING);
+      #endif
+    }
+  }
+  if (block->steps_y > 0) {
+    if ((dirs & (1<<Y_AXIS)) != 0) {
+      #if defined(Y_MIN_PIN) && Y_MIN_PIN > -1
+        ENDSTOP_HIT(Y_AXIS, endstop_y_hit, Y_MIN_PIN, Y_MIN_ENDSTOP_INVERTING);
+      #endif
+    }
+    else {
+      #if defined(Y_MAX_PIN) && Y_MAX_PIN > -1
+        ENDSTOP_HIT(Y_AXIS, endstop_y_hit, Y_MAX_PIN, Y_MAX_ENDSTOP_INVERTING);
+      #endif
+    }
+  }
+  if (block->steps_z > 0) {
+    if ((dirs & (1<<Z_AXIS)) != 0) {
+      #if defined(Z_MIN_PIN) && Z_MIN_PIN > -1
+        ENDSTOP_HIT(Z_AXIS, endstop_z_hit, Z_MIN_PIN, Z_MIN_ENDSTOP_INVERTING);
+      #endif
+    }
+    else {
+      #if defined(Z_MAX_PIN) && Z_MAX_PIN > -1
+        ENDSTOP_HIT(Z_AXIS, endstop_z_hit, Z_MAX_PIN, Z_MAX_ENDSTOP_INVERTING);
+      #endif
+    }
+  }
+
+  if (hit)
+    step_events_completed = block->step_event_count;
+}
+
+// Turns the interrupt of an endstop pin on or off, the external interrupt where the pin has one and the pin
+// change interrupt otherwise. A pin with neither is polled by the stepper interrupt.
+static void endstop_interrupt(int pin, bool enable)
+{
+  if (pin < 0) return;
+  int8_t ext = ENDSTOP_EXT_INT(pin);
+  if (ext >= 0) {
+    if (enable)
+      attachInterrupt(ext, endstop_check, CHANGE);
+    else
+      detachInterrupt(ext);
+    return;
+  }
+  int8_t group = ENDSTOP_PCINT_GROUP(pin);
+  if (group < 0) return;
+  volatile uint8_t *pcmsk = group == 0 ? &PCMSK0 : group == 1 ? &PCMSK1 : &PCMSK2;
+  if (enable) {
+    *pcmsk |= _BV(ENDSTOP_PCINT_BIT(pin));
+    PCICR |= _BV(PCIE0 + group);
+  }
+  else
+    *pcmsk &= ~_BV(ENDSTOP_PCINT_BIT(pin));
+}
+
+ISR(PCINT0_vect) { endstop_check(); }
+ISR(PCINT1_vect) { endstop_check(); }
+ISR(PCINT2_vect) { endstop_check(); }
+#endif // ENDSTOP_INTERRUPTS
+
 void enable_endstops(bool check)
 {
   check_endstops = check;
+  #ifdef ENDSTOP_INTERRUPTS
+    const int pins[] = { X_MIN_PIN, Y_MIN_PIN, Z_MIN_PIN, X_MAX_PIN, Y_MAX_PIN, Z_MAX_PIN };
+    for(int8_t i=0; i < 6; i++)
+      endstop_interrupt(pins[i], check);
+    // A move that is under way when the endstops are turned on may already be at one
+    CRITICAL_SECTION_START;
+    endstop_check();
+    CRITICAL_SECTION_END;
+  #endif
 }
 
 //         __________________________
@@ -250,21 +388,46 @@ void step_wait(){
 }
 
 
-FORCE_INLINE unsigned short calc_timer(unsigned short step_rate) {
+#ifdef ADAPTIVE_STEP_LOOPS
+#define STEP_LOOPS_DOWN_FREQUENCY ((unsigned long)MAX_STEP_ISR_FREQUENCY * (100 - STEP_LOOPS_HYSTERESIS) / 100)
+FORCE_INLINE char more_step_loops(char loops) { return loops == 4 ? 8 : loops + 1; }
+FORCE_INLINE char fewer_step_loops(char loops) { return loops == 8 ? 4 : loops - 1; }
+#endif
+
+// Converts a step rate to a timer interval and the number of steps to take per interrupt.
+// With ADAPTIVE_STEP_LOOPS loops is also the current setting, the new one is chosen with hysteresis.
+// Nothing may be printed from here, the ISR uses it. Rates that are too high are clamped
+// and noted for checkStepperErrors().
+FORCE_INLINE unsigned short rate_to_timer(unsigned short step_rate, char &loops) {
   unsigned short timer;
   if(step_rate > MAX_STEP_FREQUENCY) step_rate = MAX_STEP_FREQUENCY;
 
+#ifdef ADAPTIVE_STEP_LOOPS
+  if(loops < 1) loops = 1;
+  while(loops < 8 && step_rate > (unsigned long)loops * MAX_STEP_ISR_FREQUENCY)
+    loops = more_step_loops(loops);
+  while(loops > 1 && step_rate < fewer_step_loops(loops) * STEP_LOOPS_DOWN_FREQUENCY)
+    loops = fewer_step_loops(loops);
+  switch(loops) {
+    case 1: break;
+    case 2: step_rate >>= 1; break;
+    case 3: step_rate = ((unsigned long)step_rate * 21846) >> 16; break;
+    case 4: step_rate >>= 2; break;
+    default: step_rate >>= 3; break;
+  }
+#else
   if(step_rate > 20000) { // If steprate > 20kHz >> step 4 times
     step_rate = (step_rate >> 2)&0x3fff;
-    step_loops = 4;
+    loops = 4;
   }
   else if(step_rate > 10000) { // If steprate > 10kHz >> step 2 times
     step_rate = (step_rate >> 1)&0x7fff;
-    step_loops = 2;
+    loops = 2;
   }
   else {
-    step_loops = 1;
+    loops = 1;
   }
+#endif
 
   if(step_rate < (F_CPU/500000)) step_rate = (F_CPU/500000);
   step_rate -= (F_CPU/500000); // Correct for minimal speed
@@ -281,10 +444,42 @@ FORCE_INLINE unsigned short calc_timer(unsigned short step_rate) {
     timer = (unsigned short)pgm_read_word_near(table_address);
     timer -= (((unsigned short)pgm_read_word_near(table_address+2) * (unsigned char)(step_rate & 0x0007))>>3);
   }
-  if(timer < 100) { timer = 100; MYSERIAL.print(MSG_STEPPER_TOO_HIGH); MYSERIAL.println(step_rate); }//(20kHz this should never happen)
+  if(timer < 100) { timer = 100; step_rate_too_high = step_rate; }//(20kHz this should never happen)
   return timer;
 }
 
+FORCE_INLINE unsigned short calc_timer(unsigned short step_rate) {
+  return rate_to_timer(step_rate, step_loops);
+}
+
+// The planner converts the initial and nominal rates of each block, so starting a block
+// in the ISR costs no table lookups.
+unsigned short calc_step_timer(unsigned long step_rate, unsigned char &loops) {
+  char l = loops;
+  unsigned short timer = rate_to_timer(min(step_rate, 0xFFFFUL), l);
+  loops = l;
+  return timer;
+}
+
+#ifdef S_CURVE_ACCELERATION
+// Position on a ramp, 0 at its start to 65535 at its end. Both factors are 16 bits, so the product fits.
+FORCE_INLINE unsigned short ramp_position(unsigned long time, unsigned char shift, unsigned long inverse) {
+  return ((time >> shift) * inverse) >> 16;
+}
+
+// Quintic Bezier from v0 to v1 with the control points v0,v0,v0,v1,v1,v1, it starts and ends with no
+// acceleration: v = v0 + (v1 - v0) * t^3 * (10 - 15t + 6t^2). Everything is 16.16 fixed point.
+FORCE_INLINE unsigned short bezier_rate(unsigned short v0, unsigned short v1, unsigned short t) {
+  unsigned long t2 = ((unsigned long)t * t) >> 16;
+  unsigned long t3 = (t2 * t) >> 16;
+  unsigned long poly = 655360UL - 15UL * t + 6UL * t2; // 1.0 to 10.0 for t in 0..1
+  unsigned long s = (t3 * (poly >> 4)) >> 12;
+  if (v1 >= v0)
+    return v0 + (((unsigned long)(v1 - v0) * s) >> 16);
+  return v0 - (((unsigned long)(v0 - v1) * s) >> 16);
+}
+#endif // S_CURVE_ACCELERATION
+
 // Initializes the trapezoid generator from the current block. Called whenever a new
 // block begins.
 FORCE_INLINE void trapezoid_generator_reset() {
@@ -296,12 +491,13 @@ FORCE_INLINE void trapezoid_generator_reset() {
     old_advance = advance >>8;
   #endif
   deceleration_time = 0;
-  // step_rate to timer interval
-  OCR1A_nominal = calc_timer(current_block->nominal_rate);
+  // step_rate to timer interval, worked out by the planner
+  OCR1A_nominal = current_block->nominal_timer;
   // make a note of the number of step loops required at nominal speed
-  step_loops_nominal = step_loops;
+  step_loops_nominal = current_block->nominal_loops;
   acc_step_rate = current_block->initial_rate;
-  acceleration_time = calc_timer(acc_step_rate);
+  acceleration_time = current_block->initial_timer;
+  step_loops = current_block->initial_loops;
   OCR1A = acceleration_time;
 
 //    SERIAL_ECHO_START;
@@ -443,7 +639,7 @@ ISR(TIMER1_COMPA_vect)
     #else
     if ((((out_bits & (1<<X_AXIS)) != 0)&&(out_bits & (1<<Y_AXIS)) != 0)) {   //-X occurs for -A and -B
     #endif
-      CHECK_ENDSTOPS
+      CHECK_ENDSTOPS(X_MIN_PIN)
       {
         #ifdef DUAL_X_CARRIAGE
         // with 2 x-carriages, endstops are only checked in the homing direction for the active extruder
@@ -464,7 +660,7 @@ ISR(TIMER1_COMPA_vect)
       }
     }
     else { // +direction
-      CHECK_ENDSTOPS
+      CHECK_ENDSTOPS(X_MAX_PIN)
       {
         #ifdef DUAL_X_CARRIAGE
         // with 2 x-carriages, endstops are only checked in the homing direction for the active extruder
@@ -490,7 +686,7 @@ ISR(TIMER1_COMPA_vect)
     #else
     if ((((out_bits & (1<<X_AXIS)) != 0)&&(out_bits & (1<<Y_AXIS)) == 0)) {   // -Y occurs for -A and +B
     #endif
-      CHECK_ENDSTOPS
+      CHECK_ENDSTOPS(Y_MIN_PIN)
       {
         #if defined(Y_MIN_PIN) && Y_MIN_PIN > -1
           bool y_min_endstop=(READ(Y_MIN_PIN) != Y_MIN_ENDSTOP_INVERTING);
@@ -504,7 +700,7 @@ ISR(TIMER1_COMPA_vect)
       }
     }
     else { // +direction
-      CHECK_ENDSTOPS
+      CHECK_ENDSTOPS(Y_MAX_PIN)
       {
         #if defined(Y_MAX_PIN) && Y_MAX_PIN > -1
           bool y_max_endstop=(READ(Y_MAX_PIN) != Y_MAX_ENDSTOP_INVERTING);
@@ -526,7 +722,7 @@ ISR(TIMER1_COMPA_vect)
       #endif
 
       count_direction[Z_AXIS]=-1;
-      CHECK_ENDSTOPS
+      CHECK_ENDSTOPS(Z_MIN_PIN)
       {
         #if defined(Z_MIN_PIN) && Z_MIN_PIN > -1
           bool z_min_endstop=(READ(Z_MIN_PIN) != Z_MIN_ENDSTOP_INVERTING);
@@ -547,7 +743,7 @@ ISR(TIMER1_COMPA_vect)
       #endif
 
       count_direction[Z_AXIS]=1;
-      CHECK_ENDSTOPS
+      CHECK_ENDSTOPS(Z_MAX_PIN)
       {
         #if defined(Z_MAX_PIN) && Z_MAX_PIN > -1
           bool z_max_endstop=(READ(Z_MAX_PIN) != Z_MAX_ENDSTOP_INVERTING);
@@ -572,7 +768,10 @@ ISR(TIMER1_COMPA_vect)
       }
     #endif //!ADVANCE
 
-
+    #ifdef ENDSTOP_INTERRUPTS
+      // The pin interrupts only see the edges, an endstop that is pressed already is found when the block starts
+      if (step_events_completed == 0) endstop_check();
+    #endif
 
     for(int8_t i=0; i < step_loops; i++) { // Take multiple steps per interrupt (For high speed moves)
       #ifndef AT90USB
@@ -700,8 +899,16 @@ ISR(TIMER1_COMPA_vect)
     unsigned short step_rate;
     if (step_events_completed <= (unsigned long int)current_block->accelerate_until) { // Accelerate!
 
+      #ifdef S_CURVE_ACCELERATION
+        if ((unsigned long)acceleration_time < current_block->acceleration_ticks)
+          acc_step_rate = bezier_rate(current_block->initial_rate, current_block->cruise_rate,
+            ramp_position(acceleration_time, current_block->acceleration_shift, current_block->acceleration_inverse));
+        else
+          acc_step_rate = current_block->cruise_rate;
+      #else
       MultiU24X24toH16(acc_step_rate, acceleration_time, current_block->acceleration_rate);
       acc_step_rate += current_block->initial_rate;
+      #endif
 
       // upper limit
       if(acc_step_rate > current_block->nominal_rate)
@@ -711,6 +918,13 @@ ISR(TIMER1_COMPA_vect)
       timer = calc_timer(acc_step_rate);
       OCR1A = timer;
       acceleration_time += timer;
+      #ifdef LASER_CONSTANT_ENERGY
+        if (laser.firing == LASER_ON) {
+          unsigned short duty;
+          MultiU24X24toH16(duty, (unsigned long)acc_step_rate << current_block->laser_ramp_shift, current_block->laser_ramp_factor);
+          LASER_FIRING_OCR = duty;
+        }
+      #endif
       #ifdef ADVANCE
         for(int8_t i=0; i < step_loops; i++) {
           advance += advance_rate;
@@ -723,6 +937,13 @@ ISR(TIMER1_COMPA_vect)
       #endif
     }
     else if (step_events_completed > (unsigned long int)current_block->decelerate_after) { // Decelerate!
+      #ifdef S_CURVE_ACCELERATION
+      if ((unsigned long)deceleration_time < current_block->deceleration_ticks)
+        step_rate = bezier_rate(current_block->cruise_rate, current_block->final_rate,
+          ramp_position(deceleration_time, current_block->deceleration_shift, current_block->deceleration_inverse));
+      else
+        step_rate = current_block->final_rate;
+      #else
       MultiU24X24toH16(step_rate, deceleration_time, current_block->acceleration_rate);
 
       if(step_rate > acc_step_rate) { // Check step_rate stays positive
@@ -731,6 +952,7 @@ ISR(TIMER1_COMPA_vect)
       else {
         step_rate = acc_step_rate - step_rate; // Decelerate from aceleration end point.
       }
+      #endif
 
       // lower limit
       if(step_rate < current_block->final_rate)
@@ -740,6 +962,13 @@ ISR(TIMER1_COMPA_vect)
       timer = calc_timer(step_rate);
       OCR1A = timer;
       deceleration_time += timer;
+      #ifdef LASER_CONSTANT_ENERGY
+        if (laser.firing == LASER_ON) {
+          unsigned short duty;
+          MultiU24X24toH16(duty, (unsigned long)step_rate << current_block->laser_ramp_shift, current_block->laser_ramp_factor);
+          LASER_FIRING_OCR = duty;
+        }
+      #endif
       #ifdef ADVANCE
         for(int8_t i=0; i < step_loops; i++) {
           advance -= advance_rate;
@@ -754,6 +983,9 @@ ISR(TIMER1_COMPA_vect)
       OCR1A = OCR1A_nominal;
       // ensure we're running at the correct step rate, even if we just came off an acceleration
       step_loops = step_loops_nominal;
+      #ifdef LASER_CONSTANT_ENERGY
+        if (laser.firing == LASER_ON) LASER_FIRING_OCR = current_block->laser_intensity;
+      #endif
     }
 
     // If current block is finished, reset pointer
@@ -1016,7 +1248,7 @@ void st_init()
 void st_synchronize()
 {
   while( blocks_queued()) {
-    #ifndef LASER
+    #if !defined(LASER) || defined(LASER_ONLY)
     manage_heater();
     #endif
     manage_inactivity();
@@ -1072,6 +1304,9 @@ void finishAndDisableSteppers()
 
 void quickStop()
 {
+  #ifdef SEGMENT_COALESCING
+  discard_coalesced_move();
+  #endif
   DISABLE_STEPPER_DRIVER_INTERRUPT();
   while(blocks_queued())
     plan_discard_current_block();
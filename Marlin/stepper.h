@@ -72,8 +72,15 @@ void endstops_hit_on_purpose(); //avoid creation of the message, i.e. after home
 
 void enable_endstops(bool check); // Enable/disable endstop checking
 
+// True if the endstop of the axis was hit since endstops_hit_on_purpose(), steps is the count_position it latched
+bool endstop_trigger(int axis, long &steps);
+
 void checkStepperErrors(); //Print errors detected by the stepper
 
+// Timer interval for a step rate, loops is set to the steps to take per interrupt.
+// With ADAPTIVE_STEP_LOOPS it is chosen with hysteresis against the value passed in.
+unsigned short calc_step_timer(unsigned long step_rate, unsigned char &loops);
+
 void finishAndDisableSteppers();
 
 extern block_t *current_block;  // A pointer to the block currently being traced
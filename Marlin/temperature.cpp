@@ -34,6 +34,8 @@
 #include "temperature.h"
 #include "watchdog.h"
 
+#ifndef LASER_ONLY
+
 //===========================================================================
 //=============================public variables============================
 //===========================================================================
@@ -152,6 +154,84 @@ unsigned long watchmillis[EXTRUDERS] = ARRAY_BY_EXTRUDERS(0,0,0);
 #define SOFT_PWM_SCALE 0
 #endif
 
+// Channels serviced by the temperature ISR. A sensor needs an analog pin and a sensor type,
+// a heater output needs a pin and a sensor to regulate it. Anything else is compiled out.
+#if defined(TEMP_0_PIN) && TEMP_0_PIN > -1 && TEMP_SENSOR_0 != 0 && !defined(HEATER_0_USES_MAX6675)
+  #define HAS_TEMP_0 1
+#else
+  #define HAS_TEMP_0 0
+#endif
+#if defined(TEMP_1_PIN) && TEMP_1_PIN > -1 && TEMP_SENSOR_1 != 0
+  #define HAS_TEMP_1 1
+#else
+  #define HAS_TEMP_1 0
+#endif
+#if defined(TEMP_2_PIN) && TEMP_2_PIN > -1 && TEMP_SENSOR_2 != 0
+  #define HAS_TEMP_2 1
+#else
+  #define HAS_TEMP_2 0
+#endif
+#if defined(TEMP_BED_PIN) && TEMP_BED_PIN > -1 && TEMP_SENSOR_BED != 0
+  #define HAS_TEMP_BED 1
+#else
+  #define HAS_TEMP_BED 0
+#endif
+#define TEMP_ADC_CHANNELS (HAS_TEMP_0 + HAS_TEMP_1 + HAS_TEMP_2 + HAS_TEMP_BED)
+
+#if defined(HEATER_0_PIN) && HEATER_0_PIN > -1 && TEMP_SENSOR_0 != 0
+  #define HAS_HEATER_0 1
+#else
+  #define HAS_HEATER_0 0
+#endif
+#if EXTRUDERS > 1 && defined(HEATER_1_PIN) && HEATER_1_PIN > -1 && TEMP_SENSOR_1 != 0
+  #define HAS_HEATER_1 1
+#else
+  #define HAS_HEATER_1 0
+#endif
+#if EXTRUDERS > 2 && defined(HEATER_2_PIN) && HEATER_2_PIN > -1 && TEMP_SENSOR_2 != 0
+  #define HAS_HEATER_2 1
+#else
+  #define HAS_HEATER_2 0
+#endif
+#if defined(HEATER_BED_PIN) && HEATER_BED_PIN > -1 && TEMP_SENSOR_BED != 0
+  #define HAS_HEATER_BED 1
+#else
+  #define HAS_HEATER_BED 0
+#endif
+
+#if TEMP_ADC_CHANNELS > 0
+// Slot of each sensor in the ADC sequence, in the same order as temp_adc_pin[]
+enum TempChannel {
+  #if HAS_TEMP_0
+    TEMP_CHANNEL_0,
+  #endif
+  #if HAS_TEMP_BED
+    TEMP_CHANNEL_BED,
+  #endif
+  #if HAS_TEMP_1
+    TEMP_CHANNEL_1,
+  #endif
+  #if HAS_TEMP_2
+    TEMP_CHANNEL_2,
+  #endif
+};
+
+static const uint8_t temp_adc_pin[TEMP_ADC_CHANNELS] = {
+  #if HAS_TEMP_0
+    TEMP_0_PIN,
+  #endif
+  #if HAS_TEMP_BED
+    TEMP_BED_PIN,
+  #endif
+  #if HAS_TEMP_1
+    TEMP_1_PIN,
+  #endif
+  #if HAS_TEMP_2
+    TEMP_2_PIN,
+  #endif
+};
+#endif // TEMP_ADC_CHANNELS > 0
+
 //===========================================================================
 //=============================   functions      ============================
 //===========================================================================
@@ -1025,39 +1105,44 @@ int read_max6675()
 
 
 // Timer 0 is shared with millies
+// Each sensor takes two ticks, one to start the conversion and one to read it. A sample cycle
+// is always 8 ticks long so PID_dT stays the same, unused ticks only do the soft PWM and buttons.
 ISR(TIMER0_COMPB_vect)
 {
   //these variables are only accesible from the ISR, but static, so they don't lose their value
   static unsigned char temp_count = 0;
-  static unsigned long raw_temp_0_value = 0;
-  static unsigned long raw_temp_1_value = 0;
-  static unsigned long raw_temp_2_value = 0;
-  static unsigned long raw_temp_bed_value = 0;
   static unsigned char temp_state = 0;
+  #if TEMP_ADC_CHANNELS > 0
+  static unsigned long raw_temp_value[TEMP_ADC_CHANNELS];
+  #endif
   static unsigned char pwm_count = (1 << SOFT_PWM_SCALE);
+  #if HAS_HEATER_0
   static unsigned char soft_pwm_0;
-  #if EXTRUDERS > 1
+  #endif
+  #if HAS_HEATER_1
   static unsigned char soft_pwm_1;
   #endif
-  #if EXTRUDERS > 2
+  #if HAS_HEATER_2
   static unsigned char soft_pwm_2;
   #endif
-  #if HEATER_BED_PIN > -1
+  #if HAS_HEATER_BED
   static unsigned char soft_pwm_b;
   #endif
   
   if(pwm_count == 0){
+    #if HAS_HEATER_0
     soft_pwm_0 = soft_pwm[0];
     if(soft_pwm_0 > 0) WRITE(HEATER_0_PIN,1);
-    #if EXTRUDERS > 1
+    #endif
+    #if HAS_HEATER_1
     soft_pwm_1 = soft_pwm[1];
     if(soft_pwm_1 > 0) WRITE(HEATER_1_PIN,1);
     #endif
-    #if EXTRUDERS > 2
+    #if HAS_HEATER_2
     soft_pwm_2 = soft_pwm[2];
     if(soft_pwm_2 > 0) WRITE(HEATER_2_PIN,1);
     #endif
-    #if defined(HEATER_BED_PIN) && HEATER_BED_PIN > -1
+    #if HAS_HEATER_BED
     soft_pwm_b = soft_pwm_bed;
     if(soft_pwm_b > 0) WRITE(HEATER_BED_PIN,1);
     #endif
@@ -1066,14 +1151,16 @@ ISR(TIMER0_COMPB_vect)
     if(soft_pwm_fan > 0) WRITE(FAN_PIN,1);
     #endif
   }
+  #if HAS_HEATER_0
   if(soft_pwm_0 <= pwm_count) WRITE(HEATER_0_PIN,0);
-  #if EXTRUDERS > 1
+  #endif
+  #if HAS_HEATER_1
   if(soft_pwm_1 <= pwm_count) WRITE(HEATER_1_PIN,0);
   #endif
-  #if EXTRUDERS > 2
+  #if HAS_HEATER_2
   if(soft_pwm_2 <= pwm_count) WRITE(HEATER_2_PIN,0);
   #endif
-  #if defined(HEATER_BED_PIN) && HEATER_BED_PIN > -1
+  #if HAS_HEATER_BED
   if(soft_pwm_b <= pwm_count) WRITE(HEATER_BED_PIN,0);
   #endif
   #ifdef FAN_SOFT_PWM
@@ -1082,118 +1169,66 @@ ISR(TIMER0_COMPB_vect)
   
   pwm_count += (1 << SOFT_PWM_SCALE);
   pwm_count &= 0x7f;
-  
-  switch(temp_state) {
-    case 0: // Prepare TEMP_0
-      #if defined(TEMP_0_PIN) && (TEMP_0_PIN > -1)
-        #if TEMP_0_PIN > 7
-          ADCSRB = 1<<MUX5;
-        #else
-          ADCSRB = 0;
-        #endif
-        ADMUX = ((1 << REFS0) | (TEMP_0_PIN & 0x07));
-        ADCSRA |= 1<<ADSC; // Start conversion
-      #endif
-      lcd_buttons_update();
-      temp_state = 1;
-      break;
-    case 1: // Measure TEMP_0
-      #if defined(TEMP_0_PIN) && (TEMP_0_PIN > -1)
-        raw_temp_0_value += ADC;
-      #endif
-      #ifdef HEATER_0_USES_MAX6675 // TODO remove the blocking
-        raw_temp_0_value = read_max6675();
-      #endif
-      temp_state = 2;
-      break;
-    case 2: // Prepare TEMP_BED
-      #if defined(TEMP_BED_PIN) && (TEMP_BED_PIN > -1)
-        #if TEMP_BED_PIN > 7
-          ADCSRB = 1<<MUX5;
-        #else
-          ADCSRB = 0;
-        #endif
-        ADMUX = ((1 << REFS0) | (TEMP_BED_PIN & 0x07));
-        ADCSRA |= 1<<ADSC; // Start conversion
-      #endif
-      lcd_buttons_update();
-      temp_state = 3;
-      break;
-    case 3: // Measure TEMP_BED
-      #if defined(TEMP_BED_PIN) && (TEMP_BED_PIN > -1)
-        raw_temp_bed_value += ADC;
-      #endif
-      temp_state = 4;
-      break;
-    case 4: // Prepare TEMP_1
-      #if defined(TEMP_1_PIN) && (TEMP_1_PIN > -1)
-        #if TEMP_1_PIN > 7
-          ADCSRB = 1<<MUX5;
-        #else
-          ADCSRB = 0;
-        #endif
-        ADMUX = ((1 << REFS0) | (TEMP_1_PIN & 0x07));
-        ADCSRA |= 1<<ADSC; // Start conversion
-      #endif
-      lcd_buttons_update();
-      temp_state = 5;
-      break;
-    case 5: // Measure TEMP_1
-      #if defined(TEMP_1_PIN) && (TEMP_1_PIN > -1)
-        raw_temp_1_value += ADC;
-      #endif
-      temp_state = 6;
-      break;
-    case 6: // Prepare TEMP_2
-      #if defined(TEMP_2_PIN) && (TEMP_2_PIN > -1)
-        #if TEMP_2_PIN > 7
-          ADCSRB = 1<<MUX5;
-        #else
-          ADCSRB = 0;
-        #endif
-        ADMUX = ((1 << REFS0) | (TEMP_2_PIN & 0x07));
-        ADCSRA |= 1<<ADSC; // Start conversion
-      #endif
-      lcd_buttons_update();
-      temp_state = 7;
-      break;
-    case 7: // Measure TEMP_2
-      #if defined(TEMP_2_PIN) && (TEMP_2_PIN > -1)
-        raw_temp_2_value += ADC;
+
+  #if TEMP_ADC_CHANNELS > 0
+  unsigned char channel = temp_state >> 1;
+  if(channel < TEMP_ADC_CHANNELS) {
+    if(temp_state & 1) {
+      raw_temp_value[channel] += ADC; // Measure
+    }
+    else { // Prepare
+      unsigned char pin = temp_adc_pin[channel];
+      #ifdef MUX5
+        ADCSRB = (pin > 7) ? (1<<MUX5) : 0;
+      #else
+        ADCSRB = 0;
       #endif
-      temp_state = 0;
-      temp_count++;
-      break;
-//    default:
-//      SERIAL_ERROR_START;
-//      SERIAL_ERRORLNPGM("Temp measurement error!");
-//      break;
+      ADMUX = ((1 << REFS0) | (pin & 0x07));
+      ADCSRA |= 1<<ADSC; // Start conversion
+    }
   }
+  #endif
+  if(!(temp_state & 1))
+    lcd_buttons_update();
+
+  temp_state = (temp_state + 1) & 0x07;
+  if(temp_state == 0)
+    temp_count++;
     
   if(temp_count >= 16) // 8 ms * 16 = 128ms.
   {
     if (!temp_meas_ready) //Only update the raw values if they have been read. Else we could be updating them during reading.
     {
-      current_temperature_raw[0] = raw_temp_0_value;
-#if EXTRUDERS > 1
-      current_temperature_raw[1] = raw_temp_1_value;
+#if HAS_TEMP_0
+      current_temperature_raw[0] = raw_temp_value[TEMP_CHANNEL_0];
 #endif
-#ifdef TEMP_SENSOR_1_AS_REDUNDANT
-      redundant_temperature_raw = raw_temp_1_value;
+#ifdef HEATER_0_USES_MAX6675 // TODO remove the blocking
+      current_temperature_raw[0] = read_max6675();
+#endif
+#if HAS_TEMP_1
+  #if EXTRUDERS > 1
+      current_temperature_raw[1] = raw_temp_value[TEMP_CHANNEL_1];
+  #endif
+  #ifdef TEMP_SENSOR_1_AS_REDUNDANT
+      redundant_temperature_raw = raw_temp_value[TEMP_CHANNEL_1];
+  #endif
+#endif
+#if HAS_TEMP_2 && EXTRUDERS > 2
+      current_temperature_raw[2] = raw_temp_value[TEMP_CHANNEL_2];
 #endif
-#if EXTRUDERS > 2
-      current_temperature_raw[2] = raw_temp_2_value;
+#if HAS_TEMP_BED
+      current_temperature_bed_raw = raw_temp_value[TEMP_CHANNEL_BED];
 #endif
-      current_temperature_bed_raw = raw_temp_bed_value;
     }
     
     temp_meas_ready = true;
     temp_count = 0;
-    raw_temp_0_value = 0;
-    raw_temp_1_value = 0;
-    raw_temp_2_value = 0;
-    raw_temp_bed_value = 0;
+#if TEMP_ADC_CHANNELS > 0
+    for(unsigned char i = 0; i < TEMP_ADC_CHANNELS; i++)
+      raw_temp_value[i] = 0;
+#endif
 
+#if HAS_TEMP_0 || defined(HEATER_0_USES_MAX6675)
 #if HEATER_0_RAW_LO_TEMP > HEATER_0_RAW_HI_TEMP
     if(current_temperature_raw[0] <= maxttemp_raw[0]) {
 #else
@@ -1208,7 +1243,8 @@ ISR(TIMER0_COMPB_vect)
 #endif
         min_temp_error(0);
     }
-#if EXTRUDERS > 1
+#endif
+#if EXTRUDERS > 1 && HAS_TEMP_1
 #if HEATER_1_RAW_LO_TEMP > HEATER_1_RAW_HI_TEMP
     if(current_temperature_raw[1] <= maxttemp_raw[1]) {
 #else
@@ -1224,7 +1260,7 @@ ISR(TIMER0_COMPB_vect)
         min_temp_error(1);
     }
 #endif
-#if EXTRUDERS > 2
+#if EXTRUDERS > 2 && HAS_TEMP_2
 #if HEATER_2_RAW_LO_TEMP > HEATER_2_RAW_HI_TEMP
     if(current_temperature_raw[2] <= maxttemp_raw[2]) {
 #else
@@ -1242,7 +1278,7 @@ ISR(TIMER0_COMPB_vect)
 #endif
   
   /* No bed MINTEMP error? */
-#if defined(BED_MAXTEMP) && (TEMP_SENSOR_BED != 0)
+#if defined(BED_MAXTEMP) && HAS_TEMP_BED
 # if HEATER_BED_RAW_LO_TEMP > HEATER_BED_RAW_HI_TEMP
     if(current_temperature_bed_raw <= bed_maxttemp_raw) {
 #else
@@ -1281,3 +1317,452 @@ float unscalePID_d(float d)
 
 #endif //PIDTEMP
 
+#else //LASER_ONLY
+
+#include "laser.h"
+
+//===========================================================================
+//==================== laser diode and resin vat monitor ====================
+//===========================================================================
+// Timer0 COMPB polls the LCD buttons on every other tick and services the ADC on the ticks in between:
+// each ADC tick collects the conversion started on the previous one and starts the next channel.
+// A reading of both sensors takes 2*2*OVERSAMPLENR ticks (64ms), the calibration photodiode is sampled
+// the same way when it is fitted. The only heater is the optional one
+// on the vat, it gets the same soft PWM and bang-bang or PID control as a heated bed.
+
+float current_temperature_laser = 0.0;
+float current_temperature_vat = 0.0;
+#if HAS_VAT_HEATER
+  int target_temperature_vat = 0;
+#endif
+
+#define MONITOR_ADC_CHANNELS (HAS_LASER_TEMP + HAS_VAT_TEMP + HAS_PHOTODIODE)
+
+#ifdef PIDTEMPVAT
+  #ifndef PID_INTEGRAL_DRIVE_MAX
+    #define PID_INTEGRAL_DRIVE_MAX 255  //limit for the integral term
+  #endif
+  #ifndef K1
+    #define K1 0.95 //smoothing factor within the PID
+  #endif
+  #define K2 (1.0-K1)
+  #define VAT_PID_dT ((OVERSAMPLENR * 2.0 * MONITOR_ADC_CHANNELS)/(F_CPU / 64.0 / 256.0)) //sampling period of the monitor
+
+  float vatKp=DEFAULT_vatKp;
+  float vatKi=(DEFAULT_vatKi*VAT_PID_dT);
+  float vatKd=(DEFAULT_vatKd/VAT_PID_dT);
+
+  static float temp_iState_vat = 0;
+  static float temp_dState_vat = 0;
+  static float temp_iState_max_vat;
+  static float dTerm_vat;
+#endif //PIDTEMPVAT
+
+#if HAS_VAT_HEATER
+  static unsigned char soft_pwm_vat;
+#endif
+
+#ifdef VAT_EXPOSURE_COMPENSATION
+  uint8_t vat_exposure_mode = VAT_EXPOSURE_MODE;
+  float vat_exposure_factor = 1.0;
+  static const uint8_t vat_exposure_temps[] = VAT_EXPOSURE_TEMPS;
+  static const uint8_t vat_exposure_percent[] = VAT_EXPOSURE_PERCENT;
+  #define VAT_EXPOSURE_POINTS (sizeof(vat_exposure_temps)/sizeof(*vat_exposure_temps))
+#endif
+
+#if MONITOR_ADC_CHANNELS > 0
+// Slot of each sensor in the ADC sequence, in the same order as monitor_adc_pin[]
+enum MonitorChannel {
+  #if HAS_LASER_TEMP
+    MONITOR_CHANNEL_LASER,
+  #endif
+  #if HAS_VAT_TEMP
+    MONITOR_CHANNEL_VAT,
+  #endif
+  #if HAS_PHOTODIODE
+    MONITOR_CHANNEL_PHOTODIODE,
+  #endif
+};
+
+static const uint8_t monitor_adc_pin[MONITOR_ADC_CHANNELS] = {
+  #if HAS_LASER_TEMP
+    LASER_TEMP_PIN,
+  #endif
+  #if HAS_VAT_TEMP
+    VAT_TEMP_PIN,
+  #endif
+  #if HAS_PHOTODIODE
+    LASER_PHOTODIODE_PIN,
+  #endif
+};
+
+static volatile bool monitor_meas_ready = false;
+static unsigned int monitor_raw[MONITOR_ADC_CHANNELS]; // sum of OVERSAMPLENR samples, valid while monitor_meas_ready
+#endif //MONITOR_ADC_CHANNELS > 0
+#if HAS_PHOTODIODE
+static unsigned int current_raw_photodiode = 0;
+#endif
+
+// Thermistors read lower the hotter they get, the limits are found in tp_init()
+#if HAS_LASER_TEMP && defined(LASER_MAXTEMP)
+static unsigned int laser_maxttemp_raw = 0;
+#endif
+#if HAS_VAT_TEMP && defined(VAT_MAXTEMP)
+static unsigned int vat_maxttemp_raw = 0;
+#endif
+#if HAS_LASER_TEMP && defined(LASER_MINTEMP)
+static unsigned int laser_minttemp_raw = 1023 * OVERSAMPLENR;
+#endif
+#if HAS_VAT_TEMP && defined(VAT_MINTEMP)
+static unsigned int vat_minttemp_raw = 1023 * OVERSAMPLENR;
+#endif
+
+#define PGM_RD_W(x)   (short)pgm_read_word(&x)
+
+#if MONITOR_ADC_CHANNELS > 0
+static float analog2tempMonitor(int raw, const short (*tt)[2], uint8_t len)
+{
+  float celsius = 0;
+  uint8_t i;
+
+  for (i=1; i<len; i++)
+  {
+    if (PGM_RD_W(tt[i][0]) > raw)
+    {
+      celsius = PGM_RD_W(tt[i-1][1]) + 
+        (raw - PGM_RD_W(tt[i-1][0])) * 
+        (float)(PGM_RD_W(tt[i][1]) - PGM_RD_W(tt[i-1][1])) /
+        (float)(PGM_RD_W(tt[i][0]) - PGM_RD_W(tt[i-1][0]));
+      break;
+    }
+  }
+
+  // Overflow: Set to last value in the table
+  if (i == len) celsius = PGM_RD_W(tt[i-1][1]);
+
+  return celsius;
+}
+#endif
+
+void tp_init()
+{
+  #if HAS_VAT_HEATER
+    SET_OUTPUT(VAT_HEATER_PIN);
+  #endif
+  #ifdef PIDTEMPVAT
+    temp_iState_max_vat = PID_INTEGRAL_DRIVE_MAX / vatKi;
+  #endif
+
+  // Set analog inputs
+  ADCSRA = 1<<ADEN | 1<<ADSC | 1<<ADIF | 0x07;
+  DIDR0 = 0;
+  #ifdef DIDR2
+    DIDR2 = 0;
+  #endif
+  #if MONITOR_ADC_CHANNELS > 0
+  for(uint8_t i = 0; i < MONITOR_ADC_CHANNELS; i++) {
+    uint8_t pin = monitor_adc_pin[i];
+    if(pin < 8)
+      DIDR0 |= 1 << pin;
+    #ifdef DIDR2
+    else
+      DIDR2 |= 1 << (pin - 8);
+    #endif
+  }
+  // The ISR collects a conversion before it starts one, so have the first one running
+  #ifdef MUX5
+    ADCSRB = (monitor_adc_pin[0] > 7) ? (1<<MUX5) : 0;
+  #endif
+  ADMUX = ((1 << REFS0) | (monitor_adc_pin[0] & 0x07));
+  ADCSRA |= 1<<ADSC;
+  #endif
+
+  #if HAS_LASER_TEMP && defined(LASER_MAXTEMP)
+  while(analog2tempMonitor(laser_maxttemp_raw, LASERTEMPTABLE, LASERTEMPTABLE_LEN) > LASER_MAXTEMP)
+    laser_maxttemp_raw += OVERSAMPLENR;
+  #endif
+  #if HAS_VAT_TEMP && defined(VAT_MAXTEMP)
+  while(analog2tempMonitor(vat_maxttemp_raw, VATTEMPTABLE, VATTEMPTABLE_LEN) > VAT_MAXTEMP)
+    vat_maxttemp_raw += OVERSAMPLENR;
+  #endif
+  #if HAS_LASER_TEMP && defined(LASER_MINTEMP)
+  while(analog2tempMonitor(laser_minttemp_raw, LASERTEMPTABLE, LASERTEMPTABLE_LEN) < LASER_MINTEMP)
+    laser_minttemp_raw -= OVERSAMPLENR;
+  #endif
+  #if HAS_VAT_TEMP && defined(VAT_MINTEMP)
+  while(analog2tempMonitor(vat_minttemp_raw, VATTEMPTABLE, VATTEMPTABLE_LEN) < VAT_MINTEMP)
+    vat_minttemp_raw -= OVERSAMPLENR;
+  #endif
+
+  // Use timer0 for the monitor and the LCD buttons
+  // Interleave the monitor interrupt with millies interrupt
+  OCR0B = 128;
+  TIMSK0 |= (1<<OCIE0B);
+}
+
+/* Called to get the raw values into the the actual temperatures. The raw values are created in interrupt context,
+    and this function is called from normal context as it is too slow to run in interrupts */
+void manage_heater()
+{
+  #if MONITOR_ADC_CHANNELS > 0
+  if(!monitor_meas_ready)
+    return;
+
+  #if HAS_LASER_TEMP
+    current_temperature_laser = analog2tempMonitor(monitor_raw[MONITOR_CHANNEL_LASER], LASERTEMPTABLE, LASERTEMPTABLE_LEN);
+  #endif
+  #if HAS_VAT_TEMP
+    current_temperature_vat = analog2tempMonitor(monitor_raw[MONITOR_CHANNEL_VAT], VATTEMPTABLE, VATTEMPTABLE_LEN);
+  #endif
+  #if HAS_PHOTODIODE
+    current_raw_photodiode = monitor_raw[MONITOR_CHANNEL_PHOTODIODE];
+  #endif
+  //Reset the watchdog after we know we have a temperature measurement.
+  watchdog_reset();
+
+  CRITICAL_SECTION_START;
+  monitor_meas_ready = false;
+  CRITICAL_SECTION_END;
+  #else
+  watchdog_reset();
+  #endif
+
+  #if HAS_VAT_HEATER
+  if(current_temperature_vat <= VAT_MINTEMP || current_temperature_vat >= VAT_MAXTEMP)
+  {
+    soft_pwm_vat = 0;
+    WRITE(VAT_HEATER_PIN,LOW);
+    return;
+  }
+  #ifdef PIDTEMPVAT
+    float pid_error = target_temperature_vat - current_temperature_vat;
+    float pTerm = vatKp * pid_error;
+    temp_iState_vat += pid_error;
+    temp_iState_vat = constrain(temp_iState_vat, 0.0, temp_iState_max_vat);
+    float iTerm = vatKi * temp_iState_vat;
+
+    dTerm_vat = (vatKd * (current_temperature_vat - temp_dState_vat))*K2 + (K1 * dTerm_vat);
+    temp_dState_vat = current_temperature_vat;
+
+    float pid_output = constrain(pTerm + iTerm - dTerm_vat, 0, MAX_VAT_POWER);
+    soft_pwm_vat = (int)pid_output >> 1;
+  #else
+    if(current_temperature_vat >= target_temperature_vat)
+      soft_pwm_vat = 0;
+    else
+      soft_pwm_vat = MAX_VAT_POWER>>1;
+  #endif //PIDTEMPVAT
+  #endif //HAS_VAT_HEATER
+}
+
+#if HAS_PHOTODIODE
+unsigned int rawPhotodiode()
+{
+  // Drop a reading that is waiting, the one after it may have started before the call, so take the next one
+  manage_heater();
+  for(uint8_t readings = 0; readings < 2; readings++) {
+    while(!monitor_meas_ready);
+    manage_heater();
+  }
+  return current_raw_photodiode;
+}
+#endif
+
+#if HAS_VAT_HEATER
+int getHeaterPower() {
+  return soft_pwm_vat;
+}
+
+void disable_heater()
+{
+  target_temperature_vat = 0;
+  soft_pwm_vat = 0;
+  WRITE(VAT_HEATER_PIN,LOW);
+}
+#endif //HAS_VAT_HEATER
+
+#ifdef VAT_EXPOSURE_COMPENSATION
+// Linear interpolation of the cure curve, clamped at both ends
+void vat_exposure_update()
+{
+  if(vat_exposure_mode == VAT_EXPOSURE_OFF) {
+    vat_exposure_factor = 1.0;
+    return;
+  }
+  float t = degVat();
+  uint8_t i;
+  for(i = 1; i < VAT_EXPOSURE_POINTS - 1; i++)
+    if(t < vat_exposure_temps[i])
+      break;
+  float percent;
+  if(t <= vat_exposure_temps[0])
+    percent = vat_exposure_percent[0];
+  else if(t >= vat_exposure_temps[VAT_EXPOSURE_POINTS - 1])
+    percent = vat_exposure_percent[VAT_EXPOSURE_POINTS - 1];
+  else
+    percent = vat_exposure_percent[i-1] + (t - vat_exposure_temps[i-1]) *
+      (float)(vat_exposure_percent[i] - vat_exposure_percent[i-1]) / (float)(vat_exposure_temps[i] - vat_exposure_temps[i-1]);
+  vat_exposure_factor = percent / 100.0;
+}
+#endif //VAT_EXPOSURE_COMPENSATION
+
+#if HAS_LASER_TEMP && defined(LASER_MAXTEMP)
+static void laser_max_temp_error() {
+  laser_extinguish();
+  if(IsStopped() == false) {
+    SERIAL_ERROR_START;
+    SERIAL_ERRORLNPGM("Laser switched off. Laser diode MAXTEMP triggered !");
+    LCD_ALERTMESSAGEPGM("Err: MAXTEMP LASER");
+  }
+  #ifndef BOGUS_TEMPERATURE_FAILSAFE_OVERRIDE
+  Stop();
+  #endif
+}
+#endif
+
+#if HAS_LASER_TEMP && defined(LASER_MINTEMP)
+static void laser_min_temp_error() {
+  laser_extinguish();
+  if(IsStopped() == false) {
+    SERIAL_ERROR_START;
+    SERIAL_ERRORLNPGM("Laser switched off. Laser diode MINTEMP triggered !");
+    LCD_ALERTMESSAGEPGM("Err: MINTEMP LASER");
+  }
+  #ifndef BOGUS_TEMPERATURE_FAILSAFE_OVERRIDE
+  Stop();
+  #endif
+}
+#endif
+
+#if HAS_VAT_TEMP && defined(VAT_MINTEMP)
+static void vat_min_temp_error() {
+  disable_heater();
+  if(IsStopped() == false) {
+    SERIAL_ERROR_START;
+    SERIAL_ERRORLNPGM("Print stopped. Resin vat MINTEMP triggered !");
+    LCD_ALERTMESSAGEPGM("Err: MINTEMP VAT");
+  }
+  #ifndef BOGUS_TEMPERATURE_FAILSAFE_OVERRIDE
+  Stop();
+  #endif
+}
+#endif
+
+#if HAS_VAT_TEMP && defined(VAT_MAXTEMP)
+static void vat_max_temp_error() {
+  disable_heater();
+  if(IsStopped() == false) {
+    SERIAL_ERROR_START;
+    SERIAL_ERRORLNPGM("Print stopped. Resin vat MAXTEMP triggered !");
+    LCD_ALERTMESSAGEPGM("Err: MAXTEMP VAT");
+  }
+  #ifndef BOGUS_TEMPERATURE_FAILSAFE_OVERRIDE
+  Stop();
+  #endif
+}
+#endif
+
+// Timer 0 is shared with millies
+ISR(TIMER0_COMPB_vect)
+{
+  //these variables are only accesible from the ISR, but static, so they don't lose their value
+  static unsigned char monitor_tick = 0;
+  #if MONITOR_ADC_CHANNELS > 0
+  static unsigned char channel = 0;
+  static unsigned char samples = 0;
+  static unsigned int raw_monitor_value[MONITOR_ADC_CHANNELS];
+  #endif
+  #if HAS_VAT_HEATER
+  static unsigned char pwm_count = 0;
+  static unsigned char soft_pwm_v;
+
+  if(pwm_count == 0) {
+    soft_pwm_v = soft_pwm_vat;
+    if(soft_pwm_v > 0) WRITE(VAT_HEATER_PIN,1);
+  }
+  if(soft_pwm_v <= pwm_count) WRITE(VAT_HEATER_PIN,0);
+  pwm_count = (pwm_count + 1) & 0x7f;
+  #endif
+
+  monitor_tick ^= 1;
+  if(monitor_tick) {
+    lcd_buttons_update();
+    return;
+  }
+
+  #if MONITOR_ADC_CHANNELS > 0
+  raw_monitor_value[channel] += ADC; // Measure the conversion started on the last ADC tick
+  if(++channel >= MONITOR_ADC_CHANNELS) {
+    channel = 0;
+    samples++;
+  }
+  #ifdef MUX5
+    ADCSRB = (monitor_adc_pin[channel] > 7) ? (1<<MUX5) : 0;
+  #endif
+  ADMUX = ((1 << REFS0) | (monitor_adc_pin[channel] & 0x07));
+  ADCSRA |= 1<<ADSC; // Start conversion
+
+  if(samples < OVERSAMPLENR)
+    return;
+  samples = 0;
+
+  if (!monitor_meas_ready) //Only update the raw values if they have been read. Else we could be updating them during reading.
+  {
+    for(unsigned char i = 0; i < MONITOR_ADC_CHANNELS; i++)
+      monitor_raw[i] = raw_monitor_value[i];
+    monitor_meas_ready = true;
+  }
+
+  #if HAS_LASER_TEMP && defined(LASER_MAXTEMP)
+    if(raw_monitor_value[MONITOR_CHANNEL_LASER] <= laser_maxttemp_raw)
+      laser_max_temp_error();
+  #endif
+  #if HAS_VAT_TEMP && defined(VAT_MAXTEMP)
+    if(raw_monitor_value[MONITOR_CHANNEL_VAT] <= vat_maxttemp_raw)
+      vat_max_temp_error();
+  #endif
+  #if HAS_LASER_TEMP && defined(LASER_MINTEMP)
+    if(raw_monitor_value[MONITOR_CHANNEL_LASER] >= laser_minttemp_raw)
+      laser_min_temp_error();
+  #endif
+  #if HAS_VAT_TEMP && defined(VAT_MINTEMP)
+    if(raw_monitor_value[MONITOR_CHANNEL_VAT] >= vat_minttemp_raw)
+      vat_min_temp_error();
+  #endif
+
+  for(unsigned char i = 0; i < MONITOR_ADC_CHANNELS; i++)
+    raw_monitor_value[i] = 0;
+  #endif //MONITOR_ADC_CHANNELS > 0
+}
+
+#ifdef PIDTEMPVAT
+// Apply the scale factors to the PID values, the vat is sampled at VAT_PID_dT
+
+
+float scalePID_i(float i)
+{
+	return i*VAT_PID_dT;
+}
+
+float unscalePID_i(float i)
+{
+	return i/VAT_PID_dT;
+}
+
+float scalePID_d(float d)
+{
+    return d/VAT_PID_dT;
+}
+
+float unscalePID_d(float d)
+{
+	return d*VAT_PID_dT;
+}
+
+void updatePID()
+{
+  temp_iState_max_vat = PID_INTEGRAL_DRIVE_MAX / vatKi;
+}
+#endif //PIDTEMPVAT
+
+#endif //LASER_ONLY
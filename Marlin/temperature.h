@@ -27,6 +27,98 @@
   #include "stepper.h"
 #endif
 
+#ifdef LASER_ONLY
+// Laser/SLA profile: no heaters, only the laser diode and resin vat monitor
+#if defined(LASER_TEMP_PIN) && LASER_TEMP_PIN > -1 && LASER_TEMP_SENSOR != 0
+  #define HAS_LASER_TEMP 1
+#else
+  #define HAS_LASER_TEMP 0
+#endif
+#if defined(VAT_TEMP_PIN) && VAT_TEMP_PIN > -1 && VAT_TEMP_SENSOR != 0
+  #define HAS_VAT_TEMP 1
+#else
+  #define HAS_VAT_TEMP 0
+#endif
+#if HAS_VAT_TEMP && defined(VAT_HEATER_PIN) && VAT_HEATER_PIN > -1
+  #define HAS_VAT_HEATER 1
+#else
+  #define HAS_VAT_HEATER 0
+#endif
+#if defined(VAT_EXPOSURE_COMPENSATION) && !HAS_VAT_TEMP
+  #error "VAT_EXPOSURE_COMPENSATION needs a vat temperature sensor"
+#endif
+// The monitor owns the ADC, so it also samples the calibration photodiode
+#if defined(LASER_CALIBRATION) && defined(LASER_PHOTODIODE_PIN) && LASER_PHOTODIODE_PIN > -1
+  #define HAS_PHOTODIODE 1
+#else
+  #define HAS_PHOTODIODE 0
+#endif
+
+// public functions
+void tp_init();  //initialise the monitor and the LCD button polling
+void manage_heater(); //converts the monitor readings and runs the vat heater, call it periodically.
+
+extern float current_temperature_laser;
+extern float current_temperature_vat;
+#if HAS_VAT_HEATER
+  extern int target_temperature_vat;
+#endif
+#if HAS_PHOTODIODE
+  unsigned int rawPhotodiode(); //sum of OVERSAMPLENR samples, all taken after the call
+#endif
+
+#ifdef PIDTEMPVAT
+  extern float vatKp,vatKi,vatKd;
+  float scalePID_i(float i);
+  float scalePID_d(float d);
+  float unscalePID_i(float i);
+  float unscalePID_d(float d);
+  void updatePID();
+#endif
+
+FORCE_INLINE float degLaser() {
+  return current_temperature_laser;
+};
+
+FORCE_INLINE float degVat() {
+  return current_temperature_vat;
+};
+
+#if HAS_VAT_HEATER
+FORCE_INLINE float degTargetVat() {
+  return target_temperature_vat;
+};
+
+FORCE_INLINE void setTargetVat(const float &celsius) {
+  target_temperature_vat = celsius;
+};
+
+FORCE_INLINE bool isHeatingVat() {
+  return target_temperature_vat > current_temperature_vat;
+};
+
+FORCE_INLINE bool isCoolingVat() {
+  return target_temperature_vat < current_temperature_vat;
+};
+
+int getHeaterPower();
+void disable_heater();
+#else
+FORCE_INLINE void disable_heater() {}
+#endif
+FORCE_INLINE void autotempShutdown() {}
+
+#ifdef VAT_EXPOSURE_COMPENSATION
+#define VAT_EXPOSURE_OFF 0
+#define VAT_EXPOSURE_INTENSITY 1
+#define VAT_EXPOSURE_FEEDRATE 2
+extern uint8_t vat_exposure_mode;
+extern float vat_exposure_factor; // exposure of the current layer relative to the nominal one
+void vat_exposure_update(); // takes the factor for the next layer from the vat temperature
+#endif
+
+#else //LASER_ONLY
+
 // public functions
 void tp_init();  //initialise the heating
 void manage_heater(); //it is critical that this is called periodically.
@@ -144,5 +236,7 @@ FORCE_INLINE void autotempShutdown(){
 
 void PID_autotune(float temp, int extruder, int ncycles);
 
+#endif //LASER_ONLY
+
 #endif
 
@@ -14,6 +14,7 @@
 int8_t encoderDiff; /* encoderDiff is updated from interrupt context and added to encoderPosition every LCD update */
 
 /* Configuration settings */
+#ifndef LASER_ONLY
 int plaPreheatHotendTemp;
 int plaPreheatHPBTemp;
 int plaPreheatFanSpeed;
@@ -21,6 +22,7 @@ int plaPreheatFanSpeed;
 int absPreheatHotendTemp;
 int absPreheatHPBTemp;
 int absPreheatFanSpeed;
+#endif
 
 static float manual_feedrate[] = MANUAL_FEEDRATE;
 /* !Configuration settings */
@@ -81,6 +83,9 @@ static void lcd_sdcard_menu();
     static void action_laser_test_100_30000ms();
 	static void action_laser_acc_on();
 	static void action_laser_acc_off();
+	#ifdef LASER_LIFETIME
+	static void lcd_laser_lifetime();
+	#endif
 #endif
 
 static void lcd_quick_feedback();//Cause an LCD refresh, and give the user visual or audiable feedback that something has happend
@@ -255,6 +260,9 @@ static void lcd_sdcard_pause()
 static void lcd_sdcard_resume()
 {
     card.startFileprint();
+#ifdef PRINT_PROGRESS
+    print_progress_start();
+#endif
 }
 
 static void lcd_sdcard_stop()
@@ -321,6 +329,7 @@ static void lcd_autostart_sd()
 }
 #endif
 
+#ifndef LASER_ONLY
 void lcd_preheat_pla()
 {
     setTargetHotend0(plaPreheatHotendTemp);
@@ -351,6 +360,7 @@ static void lcd_cooldown()
     setTargetBed(0);
     lcd_return_to_status();
 }
+#endif //LASER_ONLY
 
 static void lcd_tune_menu()
 {
@@ -373,6 +383,9 @@ static void lcd_tune_menu()
 #ifdef FILAMENTCHANGEENABLE
      MENU_ITEM(gcode, MSG_FILAMENTCHANGE, PSTR("M600"));
 #endif
+#endif
+#if defined(LASER_ONLY) && HAS_VAT_HEATER
+    MENU_ITEM_EDIT(int3, MSG_VAT, &target_temperature_vat, 0, VAT_MAXTEMP - 5);
 #endif
     END_MENU();
 }
@@ -690,14 +703,17 @@ static void lcd_control_motion_menu()
 {
     START_MENU();
     MENU_ITEM(back, MSG_CONTROL, lcd_control_menu);
-    MENU_ITEM_EDIT(float5, MSG_ACC, &acceleration, 500, 99000);
+    MENU_ITEM_EDIT_CALLBACK(float5, MSG_ACC, &acceleration, 500, 99000, reset_acceleration_rates);
     MENU_ITEM_EDIT(float3, MSG_VXY_JERK, &max_xy_jerk, 1, 990);
     MENU_ITEM_EDIT(float52, MSG_VZ_JERK, &max_z_jerk, 0.1, 990);
     MENU_ITEM_EDIT(float3, MSG_VE_JERK, &max_e_jerk, 1, 990);
-    MENU_ITEM_EDIT(float3, MSG_VMAX MSG_X, &max_feedrate[X_AXIS], 1, 999);
-    MENU_ITEM_EDIT(float3, MSG_VMAX MSG_Y, &max_feedrate[Y_AXIS], 1, 999);
-    MENU_ITEM_EDIT(float3, MSG_VMAX MSG_Z, &max_feedrate[Z_AXIS], 1, 999);
-    MENU_ITEM_EDIT(float3, MSG_VMAX MSG_E, &max_feedrate[E_AXIS], 1, 999);
+#ifdef JUNCTION_DEVIATION
+    MENU_ITEM_EDIT(float52, MSG_JUNCTION_DEVIATION, &junction_deviation, 0, 1);
+#endif
+    MENU_ITEM_EDIT_CALLBACK(float3, MSG_VMAX MSG_X, &max_feedrate[X_AXIS], 1, 999, reset_acceleration_rates);
+    MENU_ITEM_EDIT_CALLBACK(float3, MSG_VMAX MSG_Y, &max_feedrate[Y_AXIS], 1, 999, reset_acceleration_rates);
+    MENU_ITEM_EDIT_CALLBACK(float3, MSG_VMAX MSG_Z, &max_feedrate[Z_AXIS], 1, 999, reset_acceleration_rates);
+    MENU_ITEM_EDIT_CALLBACK(float3, MSG_VMAX MSG_E, &max_feedrate[E_AXIS], 1, 999, reset_acceleration_rates);
     MENU_ITEM_EDIT(float3, MSG_VMIN, &minimumfeedrate, 0, 999);
     MENU_ITEM_EDIT(float3, MSG_VTRAV_MIN, &mintravelfeedrate, 0, 999);
     MENU_ITEM_EDIT_CALLBACK(long5, MSG_AMAX MSG_X, &max_acceleration_units_per_sq_second[X_AXIS], 100, 99000, reset_acceleration_rates);
@@ -705,10 +721,10 @@ static void lcd_control_motion_menu()
     MENU_ITEM_EDIT_CALLBACK(long5, MSG_AMAX MSG_Z, &max_acceleration_units_per_sq_second[Z_AXIS], 100, 99000, reset_acceleration_rates);
     MENU_ITEM_EDIT_CALLBACK(long5, MSG_AMAX MSG_E, &max_acceleration_units_per_sq_second[E_AXIS], 100, 99000, reset_acceleration_rates);
     MENU_ITEM_EDIT(float5, MSG_A_RETRACT, &retract_acceleration, 100, 99000);
-    MENU_ITEM_EDIT(float52, MSG_XSTEPS, &axis_steps_per_unit[X_AXIS], 5, 9999);
-    MENU_ITEM_EDIT(float52, MSG_YSTEPS, &axis_steps_per_unit[Y_AXIS], 5, 9999);
-    MENU_ITEM_EDIT(float51, MSG_ZSTEPS, &axis_steps_per_unit[Z_AXIS], 5, 9999);
-    MENU_ITEM_EDIT(float51, MSG_ESTEPS, &axis_steps_per_unit[E_AXIS], 5, 9999);
+    MENU_ITEM_EDIT_CALLBACK(float52, MSG_XSTEPS, &axis_steps_per_unit[X_AXIS], 5, 9999, reset_acceleration_rates);
+    MENU_ITEM_EDIT_CALLBACK(float52, MSG_YSTEPS, &axis_steps_per_unit[Y_AXIS], 5, 9999, reset_acceleration_rates);
+    MENU_ITEM_EDIT_CALLBACK(float51, MSG_ZSTEPS, &axis_steps_per_unit[Z_AXIS], 5, 9999, reset_acceleration_rates);
+    MENU_ITEM_EDIT_CALLBACK(float51, MSG_ESTEPS, &axis_steps_per_unit[E_AXIS], 5, 9999, reset_acceleration_rates);
 #ifdef ABORT_ON_ENDSTOP_HIT_FEATURE_ENABLED
     MENU_ITEM_EDIT(bool, "Endstop abort", &abort_on_endstop_hit);
 #endif
@@ -762,6 +778,9 @@ static void lcd_laser_menu()
 	MENU_ITEM(back, MSG_MAIN, lcd_main_menu);
 	MENU_ITEM(submenu, "Set Focus", lcd_laser_focus_menu);
 	MENU_ITEM(submenu, "Test Fire", lcd_laser_test_fire_menu);
+	#ifdef LASER_LIFETIME
+	MENU_ITEM(submenu, "Laser Hours", lcd_laser_lifetime);
+	#endif
 	#ifdef LASER_PERIPHERALS
 	if (laser_peripherals_ok()) {
 		MENU_ITEM(function, "Turn On Pumps/Fans", action_laser_acc_on);
@@ -786,6 +805,20 @@ static void lcd_laser_test_fire_menu() {
 }
 
 
+#ifdef LASER_LIFETIME
+static void lcd_laser_lifetime() {
+	if (lcdDrawUpdate) {
+		laser_lifetime_update();
+		lcd_implementation_drawedit(PSTR("Laser Hours"), ftostr51(laser.lifetime / 3600.0));
+	}
+	if (LCD_CLICKED) {
+		lcd_quick_feedback();
+		currentMenu = lcd_laser_menu;
+		encoderPosition = 0;
+	}
+}
+#endif // LASER_LIFETIME
+
 static void action_laser_acc_on() {
 	enquecommand_P(PSTR("M80"));
 }
@@ -1123,9 +1156,62 @@ void lcd_init()
 #endif
 }
 
+#ifdef DOGLCD
+unsigned long lcd_longest_update = 0;
+
+// Draws the current page of the picture loop and sends it, true while there are pages left
+static bool lcd_draw_page()
+{
+    u8g.setFont(u8g_font_6x10_marlin);
+    u8g.setPrintPos(125,0);
+    if (blink % 2) u8g.setColorIndex(1); else u8g.setColorIndex(0); // Set color for the alive dot
+    u8g.drawPixel(127,63); // draw alive dot
+    u8g.setColorIndex(1); // black on white
+    (*currentMenu)();
+    if (!lcdDrawUpdate)  return false; // Terminate display update, when nothing new to draw. This must be done before the last dogm.next()
+    return u8g.nextPage();
+}
+#endif
+
+#ifdef ULTIPANEL
+static unsigned long timeoutToStatus = 0;
+#endif
+
+// What is left to do when a frame has been drawn
+static void lcd_frame_done()
+{
+#ifdef LCD_HAS_STATUS_INDICATORS
+    lcd_implementation_update_indicators();
+#endif
+
+#ifdef ULTIPANEL
+    if(timeoutToStatus < millis() && currentMenu != lcd_status_screen)
+    {
+        lcd_return_to_status();
+        lcdDrawUpdate = 2;
+    }
+#endif//ULTIPANEL
+    if (lcdDrawUpdate == 2)
+        lcd_implementation_clear();
+    if (lcdDrawUpdate)
+        lcdDrawUpdate--;
+    lcd_next_update_millis = millis() + 100;
+}
+
 void lcd_update()
 {
-    static unsigned long timeoutToStatus = 0;
+#ifdef LCD_INCREMENTAL_UPDATE
+    // Set while a page is drawn. A menu action that waits for the planner gets back in here, and must not
+    // start on the picture loop that is under way.
+    static bool drawing_page = false;
+    // Set while the frame has pages left, one is drawn per call
+    static bool drawing_frame = false;
+    if (drawing_page)
+        return;
+#endif
+#ifdef DOGLCD
+    unsigned long update_start = micros();
+#endif
 
     lcd_buttons_update();
 
@@ -1153,6 +1239,17 @@ void lcd_update()
     }
     #endif//CARDINSERTED
 
+#ifdef LCD_INCREMENTAL_UPDATE
+    if (drawing_frame)
+    {
+        drawing_page = true;
+        drawing_frame = lcd_draw_page();
+        drawing_page = false;
+        if (!drawing_frame)
+            lcd_frame_done();
+    }
+    else
+#endif
     if (lcd_next_update_millis < millis())
     {
 #ifdef ULTIPANEL
@@ -1193,37 +1290,27 @@ void lcd_update()
 #ifdef DOGLCD        // Changes due to different driver architecture of the DOGM display
         blink++;     // Variable for fan animation and alive dot
         u8g.firstPage();
-        do
-        {
-            u8g.setFont(u8g_font_6x10_marlin);
-            u8g.setPrintPos(125,0);
-            if (blink % 2) u8g.setColorIndex(1); else u8g.setColorIndex(0); // Set color for the alive dot
-            u8g.drawPixel(127,63); // draw alive dot
-            u8g.setColorIndex(1); // black on white
-            (*currentMenu)();
-            if (!lcdDrawUpdate)  break; // Terminate display update, when nothing new to draw. This must be done before the last dogm.next()
-        } while( u8g.nextPage() );
+  #ifdef LCD_INCREMENTAL_UPDATE
+        // The first page now, the others on the next calls
+        drawing_page = true;
+        drawing_frame = lcd_draw_page();
+        drawing_page = false;
+        if (!drawing_frame)
+  #else
+        while (lcd_draw_page())
+            ;
+  #endif
 #else
         (*currentMenu)();
 #endif
+        lcd_frame_done();
+    }
 
-#ifdef LCD_HAS_STATUS_INDICATORS
-        lcd_implementation_update_indicators();
+#ifdef DOGLCD
+    unsigned long update_time = micros() - update_start;
+    if (update_time > lcd_longest_update)
+        lcd_longest_update = update_time;
 #endif
-
-#ifdef ULTIPANEL
-        if(timeoutToStatus < millis() && currentMenu != lcd_status_screen)
-        {
-            lcd_return_to_status();
-            lcdDrawUpdate = 2;
-        }
-#endif//ULTIPANEL
-        if (lcdDrawUpdate == 2)
-            lcd_implementation_clear();
-        if (lcdDrawUpdate)
-            lcdDrawUpdate--;
-        lcd_next_update_millis = millis() + 100;
-    }
 }
 
 void lcd_setstatus(const char* message)
@@ -15,6 +15,7 @@
 #ifdef DOGLCD
   extern int lcd_contrast;
   void lcd_setcontrast(uint8_t value);
+  extern unsigned long lcd_longest_update; // (us) the longest lcd_update() call, see M658
 #endif
 
   static unsigned char blink = 0;	// Variable for visualisation of fan rotation in GLCD
@@ -35,6 +36,7 @@
   FORCE_INLINE void lcd_buttons_update() {}
   #endif
 
+  #ifndef LASER_ONLY
   extern int plaPreheatHotendTemp;
   extern int plaPreheatHPBTemp;
   extern int plaPreheatFanSpeed;
@@ -42,6 +44,7 @@
   extern int absPreheatHotendTemp;
   extern int absPreheatHPBTemp;
   extern int absPreheatFanSpeed;
+  #endif
     
   void lcd_buzz(long duration,uint16_t freq);
   bool lcd_clicked();
@@ -486,14 +486,20 @@ static void lcd_implementation_status_screen()
 #  endif//SDSUPPORT
 # endif//LCD_WIDTH > 19
     lcd.setCursor(LCD_WIDTH - 6, 2);
-    lcd.print(LCD_STR_CLOCK[0]);
     if(starttime != 0)
     {
         uint16_t time = millis()/60000 - starttime/60000;
+        char label = LCD_STR_CLOCK[0];
+#ifdef PRINT_PROGRESS
+        if (char progress = print_progress_clock(time))
+            label = progress;
+#endif
+        lcd.print(label);
         lcd.print(itostr2(time/60));
         lcd.print(':');
         lcd.print(itostr2(time%60));
     }else{
+        lcd.print(LCD_STR_CLOCK[0]);
         lcd_printPGM(PSTR("--:--"));
     }
 #endif
@@ -8,19 +8,78 @@
 //set optimization so ARDUINO optimizes this file
 #pragma GCC optimize (3)
 
+#ifdef ST7920_HARDWARE_SPI
+#define ST7920_CLK_PIN  52 // SCK and MOSI of the ATmega1280/2560, shared with the SD card
+#define ST7920_DAT_PIN  51
+#else
 #define ST7920_CLK_PIN  LCD_PINS_D4
 #define ST7920_DAT_PIN  LCD_PINS_ENABLE
+#endif
 #define ST7920_CS_PIN   LCD_PINS_RS
 
 //#define PAGE_HEIGHT 8   //128 byte frambuffer
-//#define PAGE_HEIGHT 16  //256 byte frambuffer
+#if defined(LCD_INCREMENTAL_UPDATE) || defined(ST7920_HARDWARE_SPI)
+#define PAGE_HEIGHT 16  //256 byte frambuffer, four short pages
+#else
 #define PAGE_HEIGHT 32  //512 byte framebuffer
+#endif
 
 #define WIDTH 128
 #define HEIGHT 64
 
 #include <U8glib.h>
 
+#if defined(LCD_INCREMENTAL_UPDATE) || defined(ST7920_HARDWARE_SPI)
+// Only what changed is sent. Everything goes out after the init and after u8g_dev_rrd_st7920_resend(), until
+// a whole frame has been sent.
+static bool st7920_resend = true;
+
+static void u8g_dev_rrd_st7920_resend()
+{
+  st7920_resend = true;
+}
+#endif
+
+#ifdef ST7920_HARDWARE_SPI
+// The frame as it was last sent. A page is compared with it in 16 pixel words, the GDRAM word size, and runs
+// of changed words are sent with one address each.
+static uint8_t st7920_shadow[HEIGHT][WIDTH/8];
+// Unchanged words sent along inside a run, rather than setting the address again
+#define ST7920_WORD_GAP 2
+
+static void ST7920_HWSPI_SND_8BIT(uint8_t val)
+{
+  SPDR = val;
+  while (!(SPSR & _BV(SPIF)));
+}
+#define ST7920_SPI_SND_8BIT(v)   ST7920_HWSPI_SND_8BIT(v)
+
+// Takes the SPI bus from the SD card for a page. The card must not be selected, its settings are put back after.
+// SPI mode 3 at F_CPU / 8, the ST7920 takes up to 2.5 MHz.
+static bool st7920_spi_begin(uint8_t &spcr, uint8_t &spsr)
+{
+  if (!READ(SDSS))
+    return false;
+  spcr = SPCR;
+  spsr = SPSR;
+  SPCR = _BV(SPE) | _BV(MSTR) | _BV(CPOL) | _BV(CPHA) | _BV(SPR0);
+  SPSR = _BV(SPI2X);
+  return true;
+}
+
+static void st7920_spi_end(uint8_t spcr, uint8_t spsr)
+{
+  SPCR = spcr;
+  SPSR = spsr;
+}
+#else
+#ifdef LCD_INCREMENTAL_UPDATE
+#include <util/crc16.h>
+
+// The CRC of every row as it was last sent, a row that comes out the same is not sent again
+static uint16_t st7920_row_crc[HEIGHT];
+#endif
+
 static void ST7920_SWSPI_SND_8BIT(uint8_t val)
 {
   uint8_t i;
@@ -32,13 +91,15 @@ static void ST7920_SWSPI_SND_8BIT(uint8_t val)
     WRITE(ST7920_CLK_PIN,1);
   }
 }
+#define ST7920_SPI_SND_8BIT(v)   ST7920_SWSPI_SND_8BIT(v)
+#endif // ST7920_HARDWARE_SPI
 
 #define ST7920_CS()              {WRITE(ST7920_CS_PIN,1);u8g_10MicroDelay();}
 #define ST7920_NCS()             {WRITE(ST7920_CS_PIN,0);}
-#define ST7920_SET_CMD()         {ST7920_SWSPI_SND_8BIT(0xf8);u8g_10MicroDelay();}
-#define ST7920_SET_DAT()         {ST7920_SWSPI_SND_8BIT(0xfa);u8g_10MicroDelay();}
-#define ST7920_WRITE_BYTE(a)     {ST7920_SWSPI_SND_8BIT((a)&0xf0);ST7920_SWSPI_SND_8BIT((a)<<4);u8g_10MicroDelay();}
-#define ST7920_WRITE_BYTES(p,l)  {uint8_t i;for(i=0;i<l;i++){ST7920_SWSPI_SND_8BIT(*p&0xf0);ST7920_SWSPI_SND_8BIT(*p<<4);p++;}u8g_10MicroDelay();}
+#define ST7920_SET_CMD()         {ST7920_SPI_SND_8BIT(0xf8);u8g_10MicroDelay();}
+#define ST7920_SET_DAT()         {ST7920_SPI_SND_8BIT(0xfa);u8g_10MicroDelay();}
+#define ST7920_WRITE_BYTE(a)     {ST7920_SPI_SND_8BIT((a)&0xf0);ST7920_SPI_SND_8BIT((a)<<4);u8g_10MicroDelay();}
+#define ST7920_WRITE_BYTES(p,l)  {uint8_t i;for(i=0;i<l;i++){ST7920_SPI_SND_8BIT(*p&0xf0);ST7920_SPI_SND_8BIT(*p<<4);p++;}u8g_10MicroDelay();}
 
 uint8_t u8g_dev_rrd_st7920_128x64_fn(u8g_t *u8g, u8g_dev_t *dev, uint8_t msg, void *arg)
 {
@@ -47,12 +108,20 @@ uint8_t u8g_dev_rrd_st7920_128x64_fn(u8g_t *u8g, u8g_dev_t *dev, uint8_t msg, vo
   {
     case U8G_DEV_MSG_INIT:
       {
+#ifdef ST7920_HARDWARE_SPI
+        uint8_t spcr, spsr;
+        SET_OUTPUT(SDSS);              //the SPI only stays master with SS an output
+        WRITE(SDSS,1);
+#endif
         SET_OUTPUT(ST7920_CS_PIN);
         WRITE(ST7920_CS_PIN,0);
         SET_OUTPUT(ST7920_DAT_PIN);
         WRITE(ST7920_DAT_PIN,0);
         SET_OUTPUT(ST7920_CLK_PIN);
         WRITE(ST7920_CLK_PIN,1);
+#ifdef ST7920_HARDWARE_SPI
+        st7920_spi_begin(spcr, spsr);
+#endif
 
         ST7920_CS();
         u8g_Delay(90);                 //initial delay for boot up
@@ -72,6 +141,12 @@ uint8_t u8g_dev_rrd_st7920_128x64_fn(u8g_t *u8g, u8g_dev_t *dev, uint8_t msg, vo
         }
         ST7920_WRITE_BYTE(0x0C); //display on, cursor+blink off
         ST7920_NCS();
+#ifdef ST7920_HARDWARE_SPI
+        st7920_spi_end(spcr, spsr);
+#endif
+#if defined(LCD_INCREMENTAL_UPDATE) || defined(ST7920_HARDWARE_SPI)
+        st7920_resend = true;
+#endif
       }
       break;
 
@@ -84,9 +159,55 @@ uint8_t u8g_dev_rrd_st7920_128x64_fn(u8g_t *u8g, u8g_dev_t *dev, uint8_t msg, vo
         y = pb->p.page_y0;
         ptr = (uint8_t*)pb->buf;
 
+#ifdef ST7920_HARDWARE_SPI
+        uint8_t spcr, spsr;
+        if ( !st7920_spi_begin(spcr, spsr) )
+          break;                               //the SD card has the bus, the page differs from the shadow and goes out later
+        ST7920_CS();
+        for( i = 0; i < PAGE_HEIGHT; i ++, y ++, ptr += WIDTH/8 )
+        {
+          uint8_t *sent = st7920_shadow[y];
+          uint8_t w = 0;
+          while ( w < WIDTH/16 )
+          {
+            if ( !st7920_resend && ptr[2*w] == sent[2*w] && ptr[2*w+1] == sent[2*w+1] )
+            {
+              w++;
+              continue;
+            }
+            uint8_t last = w;
+            for( uint8_t n = w + 1; n < WIDTH/16 && n - last <= ST7920_WORD_GAP; n ++ )
+              if ( st7920_resend || ptr[2*n] != sent[2*n] || ptr[2*n+1] != sent[2*n+1] )
+                last = n;
+
+            ST7920_SET_CMD();
+            ST7920_WRITE_BYTE(0x80 | (y & 31));                   //y
+            ST7920_WRITE_BYTE(0x80 | ((y < 32 ? 0 : 8) + w));     //x in words, the lower half is right of the upper
+            ST7920_SET_DAT();
+            uint8_t *words = ptr + 2*w;
+            ST7920_WRITE_BYTES(words, 2*(last-w+1));
+            memcpy(sent + 2*w, ptr + 2*w, 2*(last-w+1));
+            w = last + 1;
+          }
+        }
+        ST7920_NCS();
+        st7920_spi_end(spcr, spsr);
+#else
         ST7920_CS();
         for( i = 0; i < PAGE_HEIGHT; i ++ )
         {
+#ifdef LCD_INCREMENTAL_UPDATE
+          uint16_t crc = 0xffff;
+          for( uint8_t j = 0; j < WIDTH/8; j ++ )
+            crc = _crc_ccitt_update(crc, ptr[j]);
+          if ( !st7920_resend && st7920_row_crc[y] == crc )
+          {
+            ptr += WIDTH/8;
+            y++;
+            continue;
+          }
+          st7920_row_crc[y] = crc;
+#endif
           ST7920_SET_CMD();
           if ( y < 32 )
           {
@@ -104,6 +225,11 @@ uint8_t u8g_dev_rrd_st7920_128x64_fn(u8g_t *u8g, u8g_dev_t *dev, uint8_t msg, vo
           y++;
         }
         ST7920_NCS();
+#endif // ST7920_HARDWARE_SPI
+#if defined(LCD_INCREMENTAL_UPDATE) || defined(ST7920_HARDWARE_SPI)
+        if ( y >= HEIGHT )
+          st7920_resend = false;
+#endif
       }
       break;
   }
@@ -19,7 +19,7 @@
 #include <math.h>
 #include "Marlin.h"
 
-#ifdef ENABLE_AUTO_BED_LEVELING
+#if defined(ENABLE_AUTO_BED_LEVELING) || defined(PLATE_TILT_COMPENSATION)
 #include "vector_3.h"
 
 vector_3::vector_3()
@@ -198,5 +198,5 @@ void matrix_3x3::debug(char* title)
 	}
 }
 
-#endif // #ifdef ENABLE_AUTO_BED_LEVELING
+#endif // ENABLE_AUTO_BED_LEVELING || PLATE_TILT_COMPENSATION
 